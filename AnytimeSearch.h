@@ -0,0 +1,207 @@
+#ifndef NPUZZLE_ANYTIMESEARCH_H
+#define NPUZZLE_ANYTIMESEARCH_H
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "GraphSearch.h"
+
+namespace search {
+    // Weights anytimeAStar() goes through: from initial down by step to 1
+    struct AnytimeOptions {
+        double initial_weight = 3.0;
+        double weight_step = 0.5;
+    };
+
+    namespace impl {
+        // Anytime repairing A* (ARA*): weighted A* run again and again with a smaller weight each
+        // time, every run picking up the open and closed sets of the last one instead of starting
+        // over. A state whose path gets shorter after it was expanded waits in an inconsistent
+        // list rather than being expanded twice in a run; the next run starts from open and that
+        // list with every cost recomputed for the new weight.
+        template<typename E, typename G, typename H>
+        class AnytimeAStar {
+        public:
+            AnytimeAStar(const E &target, G g, H h, const AnytimeOptions &options, const Limits &limits)
+                    : target_(target), g_(std::move(g)), h_(std::move(h)), limits_(limits),
+                      weight_(fixedWeight(options.initial_weight)),
+                      step_(std::max(1, static_cast<int>(options.weight_step * WEIGHT_ONE))) {}
+
+            template<typename Improved>
+            Result run(const E &start, Improved &&improved);
+
+        private:
+            enum class Mark : std::uint8_t {
+                OPEN, CLOSED, INCONSISTENT,
+                // Expanded by an earlier run
+                SEEN
+            };
+
+            using Table = std::unordered_map<NodePtr<E>, Mark, NodeHash<E>, NodeEqual<E>>;
+
+            int cost(const Node<E> &node) const {
+                return WEIGHT_ONE * g_(node) + weight_ * h_(node);
+            }
+
+            // Expands until no node in open could lead to a shorter solution at this weight, false
+            // when the limits ran out first
+            bool improve();
+
+            Result result(Result::results status, const Node<E> *goal) const;
+
+            const E target_;
+            const G g_;
+            const H h_;
+            const Limits limits_;
+            int weight_;
+            const int step_;
+            NodePool<E> pool_;
+            OpenList<E> open_;
+            Table table_;
+            std::vector<NodePtr<E>> inconsistent_;
+            std::vector<Node<E>> children_;
+            NodePtr<E> goal_ = nullptr;
+            std::int64_t steps_ = 0;
+            Statistics stats_;
+            Stopwatch stopwatch_;
+        };
+
+        template<typename E, typename G, typename H>
+        template<typename Improved>
+        Result AnytimeAStar<E, G, H>::run(const E &start, Improved &&improved) {
+            auto ps = pool_.create(start);
+            ps->setCost(cost(*ps));
+            open_.push(ps);
+            table_.emplace(ps, Mark::OPEN);
+
+            // Reparenting a node shortens the paths through it before the depths below catch up, so
+            // solutions are compared by the length of their traced path
+            auto best = std::numeric_limits<std::size_t>::max();
+            // Weight of the last run that finished; a goal found by a run the limits cut short is
+            // only known to be shorter than what that run found
+            auto proven = std::numeric_limits<double>::infinity();
+            while (true) {
+                auto complete = improve();
+                if (complete)
+                    proven = static_cast<double>(weight_) / WEIGHT_ONE;
+                if (goal_) {
+                    auto found = result(Result::SUCCESS, goal_);
+                    if (found.length() < best) {
+                        best = found.length();
+                        if (!improved(found, proven))
+                            break;
+                    }
+                }
+                if (!complete || weight_ == WEIGHT_ONE)
+                    break;
+
+                weight_ = std::max(WEIGHT_ONE, weight_ - step_);
+                for (auto node : inconsistent_) {
+                    table_.find(node)->second = Mark::OPEN;
+                    open_.push(node);
+                }
+                inconsistent_.clear();
+                for (auto &entry : table_)
+                    if (entry.second == Mark::CLOSED)
+                        entry.second = Mark::SEEN;
+                open_.reorder([this](const NodePtr<E> &node) {
+                    return cost(*node);
+                });
+            }
+
+            return result(goal_ ? Result::SUCCESS : Result::FAILED, goal_);
+        }
+
+        template<typename E, typename G, typename H>
+        bool AnytimeAStar<E, G, H>::improve() {
+            while (auto pbn = open_.peek()) {
+                // The goal has h = 0, so its cost is its length at any weight
+                if (goal_ && goal_->getCost() <= pbn->getCost())
+                    return true;
+                open_.pop();
+                auto &mark = table_.find(pbn)->second;
+                if (mark != Mark::OPEN)
+                    continue;
+                mark = Mark::CLOSED;
+
+                ++steps_;
+                log(steps_, *pbn);
+                if (check(*pbn, target_))
+                    continue;
+                if (limits_.exceeded(stats_.expanded, pbn->getCost() / WEIGHT_ONE))
+                    return false;
+
+                ++stats_.expanded;
+                expand(pbn, children_);
+                stats_.generated += static_cast<std::int64_t>(children_.size());
+                for (auto &child : children_) {
+                    auto gv = g_(child);
+                    auto iter = table_.find(&child);
+                    if (iter == table_.end()) {
+                        auto node = pool_.create(child);
+                        node->setCost(cost(*node));
+                        open_.push(node);
+                        table_.emplace(node, Mark::OPEN);
+                        if (check(*node, target_))
+                            goal_ = node;
+                    } else if (gv < g_(*iter->first)) {
+                        auto old = iter->first;
+                        old->setParent(pbn);
+                        old->setDepth(child.getDepth());
+                        old->setCost(cost(child));
+                        if (iter->second == Mark::CLOSED) {
+                            iter->second = Mark::INCONSISTENT;
+                            inconsistent_.push_back(old);
+                        } else if (iter->second != Mark::INCONSISTENT) {
+                            iter->second = Mark::OPEN;
+                            open_.push(old);
+                        }
+                    } else {
+                        ++stats_.duplicates;
+                    }
+                }
+                stats_.peak_open = std::max(stats_.peak_open, open_.size());
+            }
+            return true;
+        }
+
+        template<typename E, typename G, typename H>
+        Result AnytimeAStar<E, G, H>::result(Result::results status, const Node<E> *goal) const {
+            // Every result covers the time since the start
+            auto stats = stats_;
+            auto stopwatch = stopwatch_;
+            stopwatch.lap(stats, "search");
+            stats.peak_closed = table_.size();
+            stats.peak_memory = pool_.memory() + open_.memory() + inconsistent_.capacity() * sizeof(NodePtr<E>) +
+                                table_.bucket_count() * sizeof(void *) +
+                                table_.size() * (sizeof(void *) + sizeof(typename Table::value_type) +
+                                                 sizeof(std::size_t));
+            return {status, steps_, std::move(stats), goal ? tracePath(*goal) : Path()};
+        }
+    }
+
+    // Anytime repairing A*: finds a solution quickly with a large weight, then keeps lowering the
+    // weight and repairing the search for shorter ones until it reaches 1, where the solution is
+    // optimal, or the limits run out. improved(result, weight) is called with every shorter
+    // solution, which is at most weight times as long as the shortest, and returns false to stop
+    // there. The weight is that of the last run that finished: one found while the limits ran out
+    // is bounded by the run before, and by infinity if there was none. Returns the last solution
+    // found, FAILED if the limits ran out before the first.
+    template<typename E, typename G, typename H, typename Improved>
+    Result anytimeAStar(const E &start, const E &target, G g, H h, Improved improved,
+                        const AnytimeOptions &options = AnytimeOptions(), const Limits &limits = Limits()) {
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        impl::AnytimeAStar<E, G, H> search(target, std::move(g), std::move(h), options, limits);
+        return search.run(start, improved);
+    }
+}
+
+#endif //NPUZZLE_ANYTIMESEARCH_H
@@ -0,0 +1,466 @@
+#ifndef NPUZZLE_BATCH_H
+#define NPUZZLE_BATCH_H
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "AnytimeSearch.h"
+#include "Board.h"
+#include "BoundedSearch.h"
+#include "DistanceTable.h"
+#include "GraphSearch.h"
+#include "Reduction.h"
+
+// Non-interactive solving of many instances read one per line, spread over a pool of threads.
+//
+// Input lines hold the pieces of the start board row by row, the size follows from their count,
+// a square from 4 up to 225. 3x3, 4x4 and 5x5 boards are solved as Board<N> with the algorithm
+// asked for, the others as DynamicBoard by reductionSearch(). The target is the ordered board
+// unless the line continues with '/' and the target pieces. Blank lines and lines starting with
+// '#' are skipped.
+//
+// Every instance produces one output line as soon as it is solved, so lines come out in
+// completion order and carry the input line number as their id.
+namespace batch {
+    enum class Algorithm {
+        // A* for 3x3 to 5x5 boards, reductionSearch() for the other sizes
+        AUTO,
+        A_STAR, IDA_STAR, SMA_STAR, WEIGHTED_A_STAR,
+        // Weighted A* lowering the weight to 1 while the budget lasts, reports the last solution
+        ANYTIME,
+        // Beam search, not optimal but in fixed memory
+        BEAM,
+        // Distance tables for 3x3 boards, A* for the others
+        TABLE
+    };
+
+    enum class Format {
+        JSON, CSV
+    };
+
+    struct Options {
+        Algorithm algorithm = Algorithm::AUTO;
+        Format format = Format::JSON;
+        unsigned threads = std::thread::hardware_concurrency();
+        // Bytes each thread may hold with SMA_STAR
+        std::size_t memory = std::size_t(256) << 20;
+        // Starting weight of WEIGHTED_A_STAR and ANYTIME, solutions are at most this times the shortest
+        double weight = 2.0;
+        // States per layer of BEAM and of the stages of reductionSearch()
+        std::size_t beam_width = search::BeamOptions().width;
+        // Budget of every instance with all algorithms but TABLE, 0 for none
+        std::int64_t milliseconds = 0;
+        std::int64_t max_expanded = 0;
+        // Time after which no instance may run any longer, whenever it started
+        search::Limits::Clock::time_point deadline = search::Limits::Clock::time_point::max();
+        // File the TABLE distance table of the ordered 3x3 board is loaded from, or saved to once built
+        std::string table;
+    };
+
+    struct Instance {
+        std::size_t id = 0;
+        std::vector<int> start;
+        std::vector<int> target;
+        std::string error;
+    };
+
+    struct Outcome {
+        std::size_t id = 0;
+        int size = 0;
+        std::string status;
+        std::string error;
+        // Nodes expanded, what Options::max_expanded counts
+        std::int64_t expanded = 0;
+        double milliseconds = 0;
+        // Solution length and the blank moves as letters, see board::symbol()
+        std::size_t length = 0;
+        std::string moves;
+    };
+
+    struct Summary {
+        std::size_t puzzles = 0;
+        std::size_t solved = 0;
+        double seconds = 0;
+    };
+
+    namespace impl {
+        using board::Board;
+        using search::Node;
+        using search::Workspace;
+
+        // Lines waiting for a worker, bounded so a large input is streamed rather than loaded
+        class InstanceQueue {
+        public:
+            explicit InstanceQueue(std::size_t capacity) : capacity_(capacity) {}
+
+            void push(Instance &&instance) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                not_full_.wait(lock, [this] {
+                    return instances_.size() < capacity_;
+                });
+                instances_.push_back(std::move(instance));
+                not_empty_.notify_one();
+            }
+
+            bool pop(Instance &instance) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                not_empty_.wait(lock, [this] {
+                    return !instances_.empty() || closed_;
+                });
+                if (instances_.empty())
+                    return false;
+                instance = std::move(instances_.front());
+                instances_.pop_front();
+                not_full_.notify_one();
+                return true;
+            }
+
+            void close() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+                not_empty_.notify_all();
+            }
+
+        private:
+            const std::size_t capacity_;
+            std::mutex mutex_;
+            std::condition_variable not_empty_;
+            std::condition_variable not_full_;
+            std::deque<Instance> instances_;
+            bool closed_ = false;
+        };
+
+        // Search containers of one thread, one per supported size, reused from instance to instance
+        using Workspaces = std::tuple<Workspace<Board<3>>, Workspace<Board<4>>, Workspace<Board<5>>>;
+
+        inline bool parse(const std::string &line, Instance &instance) {
+            std::istringstream is(line);
+            std::string token;
+            auto *pieces = &instance.start;
+            while (is >> token) {
+                if (token == "/") {
+                    pieces = &instance.target;
+                    continue;
+                }
+                try {
+                    pieces->push_back(std::stoi(token));
+                } catch (const std::exception &) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<std::uint8_t N>
+        bool makeBoard(const std::vector<int> &pieces, Board<N> &board) {
+            std::array<typename Board<N>::Piece, Board<N>::SIZE> grid;
+            std::vector<bool> seen(Board<N>::SIZE, false);
+            for (auto i = 0; i < Board<N>::SIZE; ++i) {
+                auto piece = pieces[i];
+                if (piece < 0 || piece >= Board<N>::SIZE || seen[piece])
+                    return false;
+                seen[piece] = true;
+                grid[i] = static_cast<typename Board<N>::Piece>(piece);
+            }
+            board = Board<N>(grid);
+            return true;
+        }
+
+        inline bool makeGrid(const std::vector<int> &pieces, std::vector<board::DynamicBoard::Piece> &grid) {
+            std::vector<bool> seen(pieces.size(), false);
+            grid.clear();
+            for (auto piece : pieces) {
+                if (piece < 0 || piece >= static_cast<int>(pieces.size()) || seen[piece])
+                    return false;
+                seen[piece] = true;
+                grid.push_back(static_cast<board::DynamicBoard::Piece>(piece));
+            }
+            return true;
+        }
+
+        template<std::uint8_t N>
+        Board<N> orderedBoard() {
+            std::array<typename Board<N>::Piece, Board<N>::SIZE> grid;
+            for (auto i = 0; i < Board<N>::SIZE; ++i)
+                grid[i] = static_cast<typename Board<N>::Piece>((i + 1) % Board<N>::SIZE);
+            return Board<N>(grid);
+        }
+
+        // Distance tables of the 3x3 targets met so far, shared by every thread
+        class Tables {
+        public:
+            explicit Tables(std::string path) : path_(std::move(path)) {}
+
+            const board::DistanceTable<3> &get(const Board<3> &target) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto &table = tables_[target.pack()];
+                if (!table) {
+                    auto ordered = !path_.empty() && target == orderedBoard<3>();
+                    if (ordered)
+                        table = board::DistanceTable<3>::load(target, path_);
+                    if (!table) {
+                        table.reset(new board::DistanceTable<3>(target));
+                        if (ordered && !table->save(path_))
+                            std::cerr << "Warning: failed to write " << path_ << std::endl;
+                    }
+                }
+                return *table;
+            }
+
+        private:
+            const std::string path_;
+            std::mutex mutex_;
+            std::map<Board<3>::Packed, std::unique_ptr<board::DistanceTable<3>>> tables_;
+        };
+
+        inline bool lookup(const Board<3> &start, const Board<3> &target, Tables &tables, search::Result &result) {
+            result = tables.get(target).solve(start);
+            return true;
+        }
+
+        template<std::uint8_t N>
+        bool lookup(const Board<N> &, const Board<N> &, Tables &, search::Result &) {
+            return false;
+        }
+
+        // The budget of an instance starting now
+        inline search::Limits limits(const Options &options) {
+            search::Limits limits;
+            if (options.milliseconds > 0)
+                limits = search::Limits::within(std::chrono::milliseconds(options.milliseconds));
+            limits.deadline = std::min(limits.deadline, options.deadline);
+            if (options.max_expanded > 0)
+                limits.max_expanded = options.max_expanded;
+            return limits;
+        }
+
+        inline void report(const search::Result &result, const search::Limits &limits, double milliseconds,
+                           Outcome &outcome) {
+            outcome.status = result.success() ? "solved" : result.unsolvable() ? "unsolvable" :
+                                                           limits.cancelled() ? "cancelled" : "failed";
+            outcome.expanded = result.stats().expanded;
+            outcome.milliseconds = milliseconds;
+            outcome.length = result.length();
+            for (auto move : result.path().moves<board::Move>())
+                outcome.moves += board::symbol(move);
+        }
+
+        template<std::uint8_t N>
+        void solve(const Instance &instance, const Options &options, const search::Limits &limits,
+                   Workspaces &workspaces, Tables &tables, Outcome &outcome) {
+            auto start = orderedBoard<N>();
+            auto target = orderedBoard<N>();
+            if (!makeBoard(instance.start, start) ||
+                (!instance.target.empty() && (instance.target.size() != instance.start.size() ||
+                                              !makeBoard(instance.target, target)))) {
+                outcome.status = "invalid";
+                outcome.error = "pieces are not a permutation of 0.." + std::to_string(Board<N>::SIZE - 1);
+                return;
+            }
+
+            board::Goal<N> goal(target);
+            start.setGoal(goal);
+            const auto depth = [](const Node<Board<N>> &node) {
+                return node.getDepth();
+            };
+            const auto manhattan = [](const Node<Board<N>> &node) {
+                return node.get().manhattan();
+            };
+            search::Result result;
+            auto begin = std::chrono::steady_clock::now();
+            switch (options.algorithm) {
+                case Algorithm::AUTO:
+                case Algorithm::TABLE:
+                case Algorithm::A_STAR:
+                    // A* for the sizes without tables
+                    if (options.algorithm != Algorithm::TABLE || !lookup(start, target, tables, result))
+                        result = search::aStar(start, target, depth, manhattan,
+                                               std::get<Workspace<Board<N>>>(workspaces), limits);
+                    break;
+                case Algorithm::WEIGHTED_A_STAR:
+                    result = search::weightedAStar(start, target, depth, manhattan, options.weight,
+                                                   std::get<Workspace<Board<N>>>(workspaces), limits);
+                    break;
+                case Algorithm::BEAM: {
+                    search::BeamOptions beam;
+                    beam.width = options.beam_width;
+                    result = search::beamSearch(start, target, [](const Board<N> &board) {
+                        return board.manhattan();
+                    }, beam, limits);
+                    break;
+                }
+                case Algorithm::ANYTIME: {
+                    search::AnytimeOptions anytime;
+                    anytime.initial_weight = options.weight;
+                    result = search::anytimeAStar(start, target, depth, manhattan, [](const search::Result &, double) {
+                        return true;
+                    }, anytime, limits);
+                    break;
+                }
+                case Algorithm::IDA_STAR:
+                    result = search::idaStar<Board<N>>(start, target, [](const Board<N> &board) {
+                        return board.manhattan();
+                    }, limits);
+                    break;
+                case Algorithm::SMA_STAR:
+                    result = search::smaStar<Board<N>>(start, target, [](const Board<N> &board) {
+                        return board.manhattan();
+                    }, search::smaStarCapacity<Board<N>>(options.memory), limits);
+                    break;
+            }
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+            report(result, limits, elapsed.count(), outcome);
+        }
+
+        // Only reductionSearch() copes with these sizes, its stages are beam searches
+        inline void solve(const Instance &instance, int side, const Options &options, const search::Limits &limits,
+                          Outcome &outcome) {
+            if (options.algorithm != Algorithm::AUTO && options.algorithm != Algorithm::BEAM) {
+                outcome.status = "invalid";
+                outcome.error = "only beam search solves boards other than 3x3 to 5x5";
+                return;
+            }
+            std::vector<board::DynamicBoard::Piece> grid;
+            std::vector<board::DynamicBoard::Piece> target_grid;
+            for (int i = 0; i < side * side; ++i)
+                target_grid.push_back(static_cast<board::DynamicBoard::Piece>((i + 1) % (side * side)));
+            if (!makeGrid(instance.start, grid) ||
+                (!instance.target.empty() && (instance.target.size() != instance.start.size() ||
+                                              !makeGrid(instance.target, target_grid)))) {
+                outcome.status = "invalid";
+                outcome.error = "pieces are not a permutation of 0.." + std::to_string(side * side - 1);
+                return;
+            }
+
+            board::DynamicBoard start(side, std::move(grid));
+            board::DynamicBoard target(side, std::move(target_grid));
+            search::BeamOptions beam;
+            beam.width = options.beam_width;
+            auto begin = std::chrono::steady_clock::now();
+            auto result = board::reductionSearch(start, target, beam, limits);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+            report(result, limits, elapsed.count(), outcome);
+        }
+
+        inline Outcome solve(const Instance &instance, const Options &options, const search::Limits &limits,
+                             Workspaces &workspaces, Tables &tables) {
+            Outcome outcome;
+            outcome.id = instance.id;
+            if (!instance.error.empty()) {
+                outcome.status = "invalid";
+                outcome.error = instance.error;
+                return outcome;
+            }
+            switch (instance.start.size()) {
+                case Board<3>::SIZE:
+                    outcome.size = 3;
+                    solve<3>(instance, options, limits, workspaces, tables, outcome);
+                    break;
+                case Board<4>::SIZE:
+                    outcome.size = 4;
+                    solve<4>(instance, options, limits, workspaces, tables, outcome);
+                    break;
+                case Board<5>::SIZE:
+                    outcome.size = 5;
+                    solve<5>(instance, options, limits, workspaces, tables, outcome);
+                    break;
+                default: {
+                    auto side = static_cast<int>(std::lround(std::sqrt(static_cast<double>(instance.start.size()))));
+                    if (side >= 2 && side <= board::DynamicBoard::MAX_SIDE &&
+                        static_cast<std::size_t>(side * side) == instance.start.size()) {
+                        outcome.size = side;
+                        solve(instance, side, options, limits, outcome);
+                    } else {
+                        outcome.status = "invalid";
+                        outcome.error = "expected a square number of pieces from 4 to 225, got " +
+                                        std::to_string(instance.start.size());
+                    }
+                    break;
+                }
+            }
+            return outcome;
+        }
+
+        inline std::string format(const Outcome &outcome, Format format) {
+            char time[32];
+            std::snprintf(time, sizeof(time), "%.3f", outcome.milliseconds);
+            std::ostringstream os;
+            if (format == Format::CSV) {
+                os << outcome.id << ',' << outcome.size << ',' << outcome.status << ',' << outcome.expanded << ','
+                   << time << ',' << outcome.length << ',' << outcome.moves << ',' << outcome.error;
+            } else {
+                os << "{\"id\":" << outcome.id << ",\"size\":" << outcome.size << ",\"status\":\"" << outcome.status
+                   << "\",\"expanded\":" << outcome.expanded << ",\"time_ms\":" << time
+                   << ",\"length\":" << outcome.length << ",\"moves\":\"" << outcome.moves << '"';
+                if (!outcome.error.empty())
+                    os << ",\"error\":\"" << outcome.error << '"';
+                os << '}';
+            }
+            return os.str();
+        }
+    }
+
+    inline Summary run(std::istream &in, std::ostream &out, const Options &options) {
+        auto threads = options.threads == 0 ? 1 : options.threads;
+        impl::InstanceQueue queue(threads * 16);
+        impl::Tables tables(options.table);
+        std::mutex output;
+        Summary summary;
+
+        // Traced nodes would interleave with the results
+        search::setTrace(search::Trace::OFF);
+        if (options.format == Format::CSV)
+            out << "id,size,status,expanded,time_ms,length,moves,error\n";
+
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([&] {
+                impl::Workspaces workspaces;
+                Instance instance;
+                while (queue.pop(instance)) {
+                    auto outcome = impl::solve(instance, options, impl::limits(options), workspaces, tables);
+                    auto line = impl::format(outcome, options.format);
+                    std::lock_guard<std::mutex> lock(output);
+                    out << line << '\n';
+                    ++summary.puzzles;
+                    summary.solved += outcome.status == "solved";
+                }
+            });
+        }
+
+        std::string line;
+        for (std::size_t number = 1; std::getline(in, line); ++number) {
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+                continue;
+            Instance instance;
+            instance.id = number;
+            if (!impl::parse(line, instance))
+                instance.error = "pieces must be integers";
+            queue.push(std::move(instance));
+        }
+        queue.close();
+        for (auto &worker : workers)
+            worker.join();
+        out.flush();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        summary.seconds = elapsed.count();
+        return summary;
+    }
+}
+
+#endif //NPUZZLE_BATCH_H
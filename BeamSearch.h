@@ -0,0 +1,164 @@
+#ifndef NPUZZLE_BEAMSEARCH_H
+#define NPUZZLE_BEAMSEARCH_H
+
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "GraphSearch.h"
+
+namespace search {
+    struct BeamOptions {
+        // States kept from one layer to the next
+        std::size_t width = 1000;
+        // Bytes of the table of visited states
+        std::size_t table_bytes = std::size_t(8) << 20;
+    };
+
+    namespace impl {
+        // Hashes of visited states in a direct mapped table: a state that lands on a taken slot
+        // replaces it, so the table never grows and only forgets, and a forgotten state may be
+        // kept again in a later layer
+        class VisitedTable {
+        public:
+            explicit VisitedTable(std::size_t bytes) {
+                std::size_t slots = 1024;
+                while (slots * 2 * sizeof(std::uint64_t) <= bytes)
+                    slots *= 2;
+                slots_.assign(slots, 0);
+                mask_ = slots - 1;
+            }
+
+            // False when hash is in the table already, otherwise it is from now on
+            bool insert(std::uint64_t hash) noexcept {
+                // 0 marks a free slot
+                hash |= 1;
+                auto &slot = slots_[hash >> 1 & mask_];
+                if (slot == hash)
+                    return false;
+                slot = hash;
+                return true;
+            }
+
+            std::size_t memory() const noexcept {
+                return slots_.size() * sizeof(std::uint64_t);
+            }
+
+        private:
+            std::vector<std::uint64_t> slots_;
+            std::size_t mask_;
+        };
+    }
+
+    // Breadth first search that keeps only the width states of every layer with the lowest
+    // h(state) and drops the rest, for boards far too large to search optimally. It holds two
+    // layers of states, 4 bytes per state it kept to trace the solution back, and the table of
+    // visited states, so memory and time per layer stay fixed whatever the instance. The solution
+    // is not the shortest, and none may be found: FAILED when every layer is used up or the
+    // limits run out.
+    template<typename E, typename H>
+    Result beamSearch(const E &start, const E &target, H h, const BeamOptions &options = BeamOptions(),
+                      const Limits &limits = Limits()) {
+        using Move = typename E::Move;
+
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        // A kept state is its parent's index in the layer before times four plus its move
+        struct Candidate {
+            int h;
+            std::uint32_t child;
+            std::uint32_t step;
+        };
+
+        impl::Stopwatch stopwatch;
+        Statistics stats;
+        const auto width = std::min<std::size_t>(std::max<std::size_t>(options.width, 1), std::uint32_t(1) << 30);
+        impl::VisitedTable visited(options.table_bytes);
+        std::vector<E> layer{start};
+        std::vector<E> next;
+        std::vector<E> children;
+        std::vector<Candidate> candidates;
+        std::vector<std::vector<std::uint32_t>> trail;
+        std::int64_t steps = 0;
+        visited.insert(std::hash<E>()(start));
+        stopwatch.lap(stats, "setup");
+
+        auto finish = [&](Result::results result, Path path) {
+            std::size_t kept = 0;
+            for (const auto &steps_of_layer : trail)
+                kept += steps_of_layer.size();
+            stats.peak_closed = kept;
+            stats.peak_memory = visited.memory() + kept * sizeof(std::uint32_t) +
+                                (2 * width + children.capacity()) * sizeof(E) +
+                                candidates.capacity() * sizeof(Candidate);
+            stopwatch.lap(stats, "search");
+            return Result(result, steps, std::move(stats), std::move(path));
+        };
+
+        while (!layer.empty()) {
+            children.clear();
+            candidates.clear();
+            for (std::size_t i = 0; i < layer.size(); ++i) {
+                ++steps;
+                if (limits.exceeded(stats.expanded, static_cast<int>(trail.size()))) {
+                    return finish(Result::FAILED, Path());
+                }
+
+                ++stats.expanded;
+                for (auto move = Move(); move != Move::IDLE; ++move) {
+                    auto child = layer[i];
+                    if (!child.apply(move)) {
+                        continue;
+                    }
+                    ++stats.generated;
+                    if (!visited.insert(std::hash<E>()(child))) {
+                        ++stats.duplicates;
+                        continue;
+                    }
+                    if (child == target) {
+                        // Back from the target through the layers to the start
+                        Path path(trail.size() + 1);
+                        path.set(trail.size(), static_cast<int>(move));
+                        auto parent = static_cast<std::uint32_t>(i);
+                        for (auto depth = trail.size(); depth-- > 0;) {
+                            auto step = trail[depth][parent];
+                            path.set(depth, static_cast<int>(step & 3));
+                            parent = step >> 2;
+                        }
+                        return finish(Result::SUCCESS, std::move(path));
+                    }
+                    candidates.push_back({h(child), static_cast<std::uint32_t>(children.size()),
+                                          static_cast<std::uint32_t>(i << 2 | static_cast<std::size_t>(move))});
+                    children.push_back(std::move(child));
+                }
+            }
+
+            if (candidates.size() > width) {
+                std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(width),
+                                 candidates.end(), [](const Candidate &lhs, const Candidate &rhs) {
+                            return lhs.h < rhs.h;
+                        });
+                candidates.resize(width);
+            }
+            next.clear();
+            trail.emplace_back();
+            trail.back().reserve(candidates.size());
+            for (const auto &candidate : candidates) {
+                next.push_back(std::move(children[candidate.child]));
+                trail.back().push_back(candidate.step);
+            }
+            layer.swap(next);
+            stats.peak_open = std::max(stats.peak_open, layer.size());
+        }
+
+        return finish(Result::FAILED, Path());
+    }
+}
+
+#endif //NPUZZLE_BEAMSEARCH_H
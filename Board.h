@@ -8,6 +8,8 @@
 #include <cstdlib>
 #include <vector>
 
+#include "Simd.h"
+
 namespace board {
     enum class Move : std::uint8_t {
         LEFT, UP, RIGHT, DOWN, IDLE
@@ -29,9 +31,95 @@ namespace board {
         return d;
     }
 
+    constexpr Move inverse(Move d) {
+        switch (d) {
+            case Move::LEFT:
+                return Move::RIGHT;
+            case Move::UP:
+                return Move::DOWN;
+            case Move::RIGHT:
+                return Move::LEFT;
+            case Move::DOWN:
+                return Move::UP;
+            default:
+                return Move::IDLE;
+        }
+    }
+
+    // Letter of the direction the blank moves in, as solutions are printed
+    constexpr char symbol(Move d) {
+        switch (d) {
+            case Move::LEFT:
+                return 'L';
+            case Move::UP:
+                return 'U';
+            case Move::RIGHT:
+                return 'R';
+            case Move::DOWN:
+                return 'D';
+            default:
+                return '-';
+        }
+    }
+
+    namespace impl {
+        constexpr int bitWidth(int value) {
+            int bits = 0;
+            for (; value != 0; value >>= 1)
+                ++bits;
+            return bits;
+        }
+
+        constexpr std::uint64_t splitmix64(std::uint64_t &state) {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // Zobrist keys, one random word per (piece, position)
+        template<int SIZE>
+        struct ZobristKeys {
+            std::uint64_t keys[SIZE][SIZE];
+        };
+
+        template<int SIZE>
+        constexpr ZobristKeys<SIZE> makeZobristKeys() {
+            ZobristKeys<SIZE> table{};
+            std::uint64_t state = SIZE;
+            for (int piece = 0; piece < SIZE; ++piece)
+                for (int index = 0; index < SIZE; ++index)
+                    table.keys[piece][index] = splitmix64(state);
+            return table;
+        }
+
+        // Cell the blank reaches from each cell in each direction, -1 off the board and for IDLE
+        template<int N>
+        struct MoveTable {
+            std::int8_t next[N * N][5];
+        };
+
+        template<int N>
+        constexpr MoveTable<N> makeMoveTable() {
+            MoveTable<N> table{};
+            for (int i = 0; i < N * N; ++i) {
+                auto column = i % N;
+                table.next[i][static_cast<int>(Move::LEFT)] = static_cast<std::int8_t>(column != 0 ? i - 1 : -1);
+                table.next[i][static_cast<int>(Move::UP)] = static_cast<std::int8_t>(i >= N ? i - N : -1);
+                table.next[i][static_cast<int>(Move::RIGHT)] = static_cast<std::int8_t>(column != N - 1 ? i + 1 : -1);
+                table.next[i][static_cast<int>(Move::DOWN)] = static_cast<std::int8_t>(i < N * N - N ? i + N : -1);
+                table.next[i][static_cast<int>(Move::IDLE)] = -1;
+            }
+            return table;
+        }
+    }
+
     template<std::uint8_t N>
     class Board;
 
+    template<std::uint8_t N>
+    class Goal;
+
     template<std::uint8_t N>
     using BoardPtr = std::unique_ptr<Board<N>>;
 
@@ -39,11 +127,26 @@ namespace board {
     class Board {
     public:
         using Piece = std::uint8_t;
+        using Move = board::Move;
 
         static constexpr int SIZE = N * N;
 
+        // Every piece in PACK_BITS bits, PACK_WIDTH pieces per 64-bit word: a 4x4 board fits in one word
+        static constexpr int PACK_BITS = impl::bitWidth(SIZE - 1);
+        static constexpr int PACK_WIDTH = 64 / PACK_BITS;
+        static constexpr int PACK_WORDS = (SIZE + PACK_WIDTH - 1) / PACK_WIDTH;
+
+        using Packed = std::array<std::uint64_t, PACK_WORDS>;
+
+        // The grid is kept in whole 16-byte blocks for the SIMD kernels, the cells past SIZE are 0
+        static constexpr int GRID_BYTES = (SIZE + 15) / 16 * 16;
+
         Board(std::initializer_list<Piece> il);
 
+        explicit Board(const std::array<Piece, SIZE> &grid);
+
+        explicit Board(const Packed &packed);
+
         Board(const Board &rhs) = default;
 
         Board(Board &&rhs) noexcept = default;
@@ -55,50 +158,178 @@ namespace board {
         ~Board() = default;
 
         bool operator==(const Board &rhs) const {
-            return hashcode_ == rhs.hashcode_ &&
-                   std::equal(std::cbegin(grid_), std::cend(grid_), std::cbegin(rhs.grid_), std::cend(rhs.grid_));
+            return hashcode_ == rhs.hashcode_ && packed_ == rhs.packed_;
         }
 
         bool operator!=(const Board &rhs) const {
             return !(rhs == *this);
         }
 
-        Piece &operator[](std::size_t n) {
+        const Piece &operator[](std::size_t n) const {
             return grid_[n];
         }
 
-        const Piece &operator[](std::size_t n) const {
-            return grid_[n];
+        std::size_t hashCode() const noexcept {
+            return hashcode_;
+        }
+
+        const Packed &pack() const noexcept {
+            return packed_;
+        }
+
+        int blankIndex() const noexcept {
+            return blank_index_;
+        }
+
+        // Keeps manhattan() and misplaced() up to date against goal, which must outlive the board
+        void setGoal(const Goal<N> &goal) noexcept;
+
+        const Goal<N> *goal() const noexcept {
+            return goal_;
+        }
+
+        int manhattan() const noexcept {
+            return manhattan_;
+        }
+
+        int misplaced() const noexcept {
+            return misplaced_;
         }
 
         bool moveBlank(Move direction) noexcept;
 
-        std::vector<BoardPtr<N>> expand();
+        // The move of the search engines, see GraphSearch.h
+        bool apply(Move direction) noexcept {
+            return moveBlank(direction);
+        }
+
+        // Cell the blank would move to, -1 if direction leads off the board
+        static int neighbor(int index, Move direction) noexcept {
+            return MOVES.next[index][static_cast<int>(direction)];
+        }
+
+        // Calls visit(board, move) with this board moved each legal way in turn and restores it
+        // after each call, so successors are produced in place without copying the board
+        template<typename Visit>
+        int expand(Visit &&visit);
 
         int compatibilityCalculate(const Board &board) const;
 
         int similarityCalculate(const Board &board) const;
 
+        // Invariant of every move: the inversions among the pieces, plus the row of the blank
+        // when N is even, taken modulo 2
+        int parity() const noexcept;
+
     private:
         int locate(Piece piece) const noexcept {
-            int i;
-            for (i = 0; grid_[i] != piece && i < SIZE; ++i)
-                continue;
-            return i;
+            return static_cast<int>(simd::find(grid_.data(), GRID_BYTES, piece));
         }
 
-        // BKDR hash
-        static std::size_t hash(const Board &board) noexcept;
+        static int shift(int index) noexcept {
+            return index % PACK_WIDTH * PACK_BITS;
+        }
 
-        std::array<Piece, SIZE> grid_;
-        int blank_index_;
+        static Piece unpackPiece(const Packed &packed, int index) noexcept {
+            return static_cast<Piece>((packed[index / PACK_WIDTH] >> shift(index)) & ((1U << PACK_BITS) - 1));
+        }
+
+        // Toggles piece in the packed encoding and the hash at index, the blank is never recorded
+        void toggle(Piece piece, int index) noexcept {
+            packed_[index / PACK_WIDTH] ^= static_cast<std::uint64_t>(piece) << shift(index);
+            hashcode_ ^= ZOBRIST.keys[piece][index];
+        }
+
+        void rebuild() noexcept;
+
+        static constexpr impl::ZobristKeys<SIZE> ZOBRIST = impl::makeZobristKeys<SIZE>();
+
+        static constexpr impl::MoveTable<N> MOVES = impl::makeMoveTable<N>();
+
+        alignas(16) std::array<Piece, GRID_BYTES> grid_;
+        Packed packed_;
         std::size_t hashcode_;
+        int blank_index_;
+        const Goal<N> *goal_ = nullptr;
+        int manhattan_ = 0;
+        int misplaced_ = 0;
+    };
+
+    // Position tables of a target board, shared by every board searching towards it
+    template<std::uint8_t N>
+    class Goal {
+    public:
+        using Piece = typename Board<N>::Piece;
+
+        static constexpr int SIZE = Board<N>::SIZE;
+
+        explicit Goal(const Board<N> &target);
+
+        const Board<N> &target() const noexcept {
+            return target_;
+        }
+
+        int index(Piece piece) const noexcept {
+            return index_[piece];
+        }
+
+        // Manhattan distance of piece at index from its target position, 0 for the blank
+        int distance(Piece piece, int index) const noexcept {
+            return distance_[piece][index];
+        }
+
+        // Change of the Manhattan distance when the blank moves in direction onto piece at index
+        int delta(Piece piece, int index, Move direction) const noexcept {
+            return delta_[piece][index][static_cast<int>(direction)];
+        }
+
+        int misplaced(Piece piece, int index) const noexcept {
+            return piece != 0 && target_[index] != piece;
+        }
+
+    private:
+        Board<N> target_;
+        std::array<int, SIZE> index_;
+        std::array<std::array<std::uint8_t, SIZE>, SIZE> distance_;
+        std::array<std::array<std::array<std::int8_t, 4>, SIZE>, SIZE> delta_;
     };
 
+    template<std::uint8_t N>
+    Goal<N>::Goal(const Board<N> &target) : target_(target) {
+        for (auto i = 0; i < SIZE; ++i)
+            index_[target_[i]] = i;
+        for (auto piece = 0; piece < SIZE; ++piece) {
+            auto j = index_[piece];
+            for (auto i = 0; i < SIZE; ++i)
+                distance_[piece][i] = piece == 0 ? 0 : static_cast<std::uint8_t>(
+                        std::abs(i % N - j % N) + std::abs(i / N - j / N));
+        }
+        // The piece moves from index to the cell the blank leaves, one step against direction
+        for (auto piece = 0; piece < SIZE; ++piece)
+            for (auto i = 0; i < SIZE; ++i)
+                for (auto move = Move::LEFT; move != Move::IDLE; ++move) {
+                    auto to = Board<N>::neighbor(i, inverse(move));
+                    delta_[piece][i][static_cast<int>(move)] = static_cast<std::int8_t>(
+                            to < 0 ? 0 : distance_[piece][to] - distance_[piece][i]);
+                }
+    }
+
+    template<std::uint8_t N>
+    constexpr impl::ZobristKeys<Board<N>::SIZE> Board<N>::ZOBRIST;
+
+    template<std::uint8_t N>
+    constexpr impl::MoveTable<N> Board<N>::MOVES;
+
     template<std::uint8_t N>
     std::istream &operator>>(std::istream &is, Board<N> &board) {
-        for (int i = 0; i < Board<N>::SIZE; ++i)
-            is >> board[i];
+        std::array<typename Board<N>::Piece, Board<N>::SIZE> grid;
+        for (auto &piece : grid) {
+            int value = 0;
+            is >> value;
+            piece = static_cast<typename Board<N>::Piece>(value);
+        }
+        if (is)
+            board = Board<N>(grid);
         return is;
     }
 
@@ -114,96 +345,133 @@ namespace board {
 
     template<std::uint8_t N>
     Board<N>::Board(std::initializer_list<Piece> il) {
+        grid_.fill(0);
         std::copy(il.begin(), il.end(), std::begin(grid_));
+        rebuild();
+    }
+
+    template<std::uint8_t N>
+    Board<N>::Board(const std::array<Piece, SIZE> &grid) {
+        grid_.fill(0);
+        std::copy(grid.begin(), grid.end(), std::begin(grid_));
+        rebuild();
+    }
+
+    template<std::uint8_t N>
+    Board<N>::Board(const Packed &packed) {
+        grid_.fill(0);
+        for (auto i = 0; i < SIZE; ++i)
+            grid_[i] = unpackPiece(packed, i);
+        rebuild();
+    }
+
+    template<std::uint8_t N>
+    void Board<N>::rebuild() noexcept {
+        packed_.fill(0);
+        hashcode_ = 0;
+        for (auto i = 0; i < SIZE; ++i)
+            if (grid_[i] != 0)
+                toggle(grid_[i], i);
         blank_index_ = locate(0);
-        hashcode_ = hash(*this);
     }
 
     template<std::uint8_t N>
-    bool Board<N>::moveBlank(Move direction) noexcept {
-        using std::swap;
-        int next = blank_index_;
-        switch (direction) {
-            case Move::LEFT:
-                if ((blank_index_ % N) != 0) {
-                    next = blank_index_ - 1;
-                    swap(grid_[blank_index_], grid_[next]);
-                }
-                break;
-            case Move::UP:
-                if (blank_index_ >= N) {
-                    next = blank_index_ - N;
-                    swap(grid_[blank_index_], grid_[next]);
-                }
-                break;
-            case Move::RIGHT:
-                if ((blank_index_ % N) != N - 1) {
-                    next = blank_index_ + 1;
-                    swap(grid_[blank_index_], grid_[next]);
-                }
-                break;
-            case Move::DOWN:
-                if (blank_index_ < SIZE - N) {
-                    next = blank_index_ + N;
-                    swap(grid_[blank_index_], grid_[next]);
-                }
-                break;
-            default:
-                break;
-        }
+    void Board<N>::setGoal(const Goal<N> &goal) noexcept {
+        goal_ = &goal;
+        manhattan_ = 0;
+        for (auto i = 0; i < SIZE; ++i)
+            manhattan_ += goal.distance(grid_[i], i);
+        // Skipping the blank of the target instead of our own counts the same: when the blanks
+        // differ each side has exactly one such cell
+        misplaced_ = compatibilityCalculate(goal.target());
+    }
 
-        if (blank_index_ != next) {
-            blank_index_ = next;
-            hashcode_ = hash(*this);
-            return true;
+    template<std::uint8_t N>
+    bool Board<N>::moveBlank(Move direction) noexcept {
+        int next = neighbor(blank_index_, direction);
+        if (next < 0)
+            return false;
+
+        // The moved piece now sits where the blank was
+        auto piece = grid_[next];
+        grid_[blank_index_] = piece;
+        grid_[next] = 0;
+        toggle(piece, next);
+        toggle(piece, blank_index_);
+        if (goal_) {
+            manhattan_ += goal_->delta(piece, next, direction);
+            misplaced_ += goal_->misplaced(piece, blank_index_) - goal_->misplaced(piece, next);
         }
-        return false;
+        blank_index_ = next;
+        return true;
     }
 
     template<std::uint8_t N>
-    std::vector<BoardPtr<N>> Board<N>::expand() {
-        std::vector<BoardPtr<N>> children;
-        children.reserve(4);
-        for (auto next = Move::LEFT; next != Move::IDLE; ++next) {
-            auto child = std::make_unique<Board<N>>(*this);
-            if (child->moveBlank(next)) {
-                children.push_back(std::move(child));
+    template<typename Visit>
+    int Board<N>::expand(Visit &&visit) {
+        int count = 0;
+        for (auto move = Move::LEFT; move != Move::IDLE; ++move) {
+            if (moveBlank(move)) {
+                visit(static_cast<const Board &>(*this), move);
+                moveBlank(inverse(move));
+                ++count;
             }
         }
-        return children;
+        return count;
     }
 
     template<std::uint8_t N>
     int Board<N>::compatibilityCalculate(const Board &board) const {
-        int c = 0;
-        for (auto i = 0; i < SIZE; ++i) {
-            if (grid_[i] != board.grid_[i]) {
-                ++c;
-            }
-        }
-        return c;
+        return simd::mismatches(grid_.data(), board.grid_.data(), GRID_BYTES);
     }
 
     template<std::uint8_t N>
     int Board<N>::similarityCalculate(const Board &board) const {
         // Manhattan distance
+        std::array<int, SIZE> index;
+        for (auto i = 0; i < SIZE; ++i)
+            index[board.grid_[i]] = i;
         int c = 0;
         for (auto i = 0; i < SIZE; ++i) {
-            auto j = board.locate(grid_[i]);
-            c += std::abs(static_cast<int>(i % N - j % N)) + std::abs(static_cast<int>(i / N - j / N));
+            if (grid_[i] == 0)
+                continue;
+            auto j = index[grid_[i]];
+            c += std::abs(i % N - j % N) + std::abs(i / N - j / N);
         }
         return c;
     }
 
     template<std::uint8_t N>
-    std::size_t Board<N>::hash(const Board &board) noexcept {
-        constexpr auto SEED = 131;      // the magic number, 31, 131, 1313, 13131, etc..
-        constexpr auto LENGTH = 0x7FFFFFFF;  // hash 表长度
-        std::size_t hash{0};
-        for (const auto i : board.grid_)
-            hash = hash * SEED + i;
-        return hash % LENGTH;
+    int Board<N>::parity() const noexcept {
+        // A horizontal move keeps the order of the pieces, a vertical one carries a piece past
+        // N - 1 others and changes the row of the blank by one
+        int inversions = 0;
+        for (auto i = 0; i < SIZE; ++i) {
+            if (grid_[i] == 0)
+                continue;
+            for (auto j = i + 1; j < SIZE; ++j)
+                if (grid_[j] != 0 && grid_[j] < grid_[i])
+                    ++inversions;
+        }
+        if (N % 2 == 0)
+            inversions += blank_index_ / N;
+        return inversions % 2;
+    }
+
+    // Whether target can be reached from start at all, the moves split the boards in two halves
+    template<std::uint8_t N>
+    inline bool solvable(const Board<N> &start, const Board<N> &target) noexcept {
+        return start.parity() == target.parity();
     }
 }
 
+namespace std {
+    template<std::uint8_t N>
+    struct hash<board::Board<N>> {
+        std::size_t operator()(const board::Board<N> &board) const noexcept {
+            return board.hashCode();
+        }
+    };
+}
+
 #endif //NPUZZLE_BOARD_H
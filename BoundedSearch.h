@@ -0,0 +1,291 @@
+#ifndef NPUZZLE_BOUNDEDSEARCH_H
+#define NPUZZLE_BOUNDEDSEARCH_H
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "GraphSearch.h"
+
+namespace search {
+    namespace impl {
+        // Simplified memory-bounded A* (SMA*) over a tree holding at most a fixed number of nodes.
+        // When it is full the worst leaf, highest f and shallowest first, is evicted and its parent
+        // remembers the lowest f of the children it lost; once that is the best cost left, the
+        // parent is expanded again to bring them back. Every node keeps the lowest f below it, so
+        // the cost of a forgotten subtree is never lost. Moves cost 1 and h must be admissible.
+        template<typename E, typename H = Heuristic<E>>
+        class SmaStar {
+        public:
+            using Move = typename E::Move;
+
+            // Moves a state has at most, each node keeps a slot for the child of every one of them
+            static constexpr int BRANCHES = 4;
+
+            SmaStar(const E &target, H h, std::size_t capacity)
+                    : target_(target), h_(std::move(h)),
+                      capacity_(std::max<std::size_t>(capacity, BRANCHES + 1)) {
+                nodes_.reserve(capacity_);
+            }
+
+            Result run(const E &start, const Limits &limits);
+
+            // Bytes one node takes: its entry, its keys in open and leaves, and its free slot
+            static constexpr std::size_t nodeBytes() {
+                return sizeof(Entry) + 2 * SET_NODE + sizeof(int);
+            }
+
+        private:
+            static constexpr int INF = std::numeric_limits<int>::max();
+            static constexpr int NONE = -1;
+
+            struct Entry {
+                explicit Entry(const E &state) : state(state) {}
+
+                E state;
+                int parent = NONE;
+                int children[BRANCHES] = {NONE, NONE, NONE, NONE};
+                int g = 0;
+                // Lower bound on a solution through the node, backed up from its children
+                int f = 0;
+                // Lowest f of the children evicted since the node was last expanded
+                int forgotten = INF;
+                // Costs the node is filed under in open and leaves, NONE when it is not
+                int queued = NONE;
+                int listed = NONE;
+                Move move = Move::IDLE;
+                bool expanded = false;
+            };
+
+            // Cost, depth negated so deeper nodes come first among equal costs, and index
+            using Key = std::tuple<int, int, int>;
+
+            // Red-black tree node of std::set: colour, parent, two children and the key
+            static constexpr std::size_t SET_NODE = 4 * sizeof(void *) + sizeof(Key);
+
+            int allocate(const E &state);
+
+            bool reserve();
+
+            void evict(int index);
+
+            void refresh(int index);
+
+            void backup(int index);
+
+            void expand(int index);
+
+            Path tracePath(int index) const;
+
+            const E target_;
+            const H h_;
+            const std::size_t capacity_;
+            std::vector<Entry> nodes_;
+            std::vector<int> free_;
+            // Unexpanded nodes by f, and expanded ones with forgotten children by the lowest of them
+            std::set<Key> open_;
+            // Nodes without children in memory, the candidates for eviction
+            std::set<Key> leaves_;
+            int expanding_ = NONE;
+            std::size_t size_ = 0;
+            std::size_t peak_leaves_ = 0;
+            Statistics stats_;
+        };
+
+        template<typename E, typename H>
+        Result SmaStar<E, H>::run(const E &start, const Limits &limits) {
+            Stopwatch stopwatch;
+            std::int64_t steps = 0;
+            auto root = allocate(start);
+            nodes_[root].f = h_(start);
+            refresh(root);
+
+            int goal = NONE;
+            while (!open_.empty()) {
+                auto index = std::get<2>(*open_.begin());
+                ++steps;
+                log(steps, nodes_[index].state, nodes_[index].g);
+                if (!nodes_[index].expanded && nodes_[index].state == target_) {
+                    goal = index;
+                    break;
+                }
+                if (limits.exceeded(stats_.expanded, std::get<0>(*open_.begin())))
+                    break;
+                expand(index);
+                stats_.peak_open = std::max(stats_.peak_open, open_.size());
+                stats_.peak_closed = std::max(stats_.peak_closed, size_ - open_.size());
+                peak_leaves_ = std::max(peak_leaves_, leaves_.size());
+            }
+
+            stats_.peak_memory = nodes_.capacity() * sizeof(Entry) + free_.capacity() * sizeof(int) +
+                                 (stats_.peak_open + peak_leaves_) * SET_NODE;
+            stopwatch.lap(stats_, "search");
+            if (goal == NONE)
+                return {Result::FAILED, steps, std::move(stats_)};
+            return {Result::SUCCESS, steps, std::move(stats_), tracePath(goal)};
+        }
+
+        template<typename E, typename H>
+        int SmaStar<E, H>::allocate(const E &state) {
+            ++size_;
+            if (free_.empty()) {
+                nodes_.emplace_back(state);
+                return static_cast<int>(nodes_.size() - 1);
+            }
+            auto index = free_.back();
+            free_.pop_back();
+            nodes_[index] = Entry(state);
+            return index;
+        }
+
+        // Makes room for one more node, false when nothing is left to evict
+        template<typename E, typename H>
+        bool SmaStar<E, H>::reserve() {
+            while (size_ >= capacity_) {
+                if (leaves_.empty())
+                    return false;
+                evict(std::get<2>(*leaves_.rbegin()));
+            }
+            return true;
+        }
+
+        template<typename E, typename H>
+        void SmaStar<E, H>::evict(int index) {
+            auto &node = nodes_[index];
+            if (node.queued != NONE)
+                open_.erase(Key(node.queued, -node.g, index));
+            if (node.listed != NONE)
+                leaves_.erase(Key(node.listed, -node.g, index));
+
+            auto &parent = nodes_[node.parent];
+            parent.children[static_cast<int>(node.move)] = NONE;
+            parent.forgotten = std::min(parent.forgotten, node.f);
+            free_.push_back(index);
+            --size_;
+            ++stats_.evicted;
+            refresh(node.parent);
+        }
+
+        // Files the node in open and leaves under its current costs; nodes that cannot reach the
+        // target within the budget stay out of open but are the first to be evicted
+        template<typename E, typename H>
+        void SmaStar<E, H>::refresh(int index) {
+            auto &node = nodes_[index];
+            if (node.queued != NONE)
+                open_.erase(Key(node.queued, -node.g, index));
+            if (node.listed != NONE)
+                leaves_.erase(Key(node.listed, -node.g, index));
+
+            node.queued = node.expanded ? node.forgotten : node.f;
+            if (node.queued == INF)
+                node.queued = NONE;
+            else
+                open_.insert(Key(node.queued, -node.g, index));
+
+            // The root has no parent to back its cost up to
+            auto leaf = node.parent != NONE && index != expanding_ &&
+                        std::all_of(std::begin(node.children), std::end(node.children), [](int child) {
+                            return child == NONE;
+                        });
+            node.listed = leaf ? node.f : NONE;
+            if (leaf)
+                leaves_.insert(Key(node.listed, -node.g, index));
+        }
+
+        // Sets f of an expanded node to the lowest below it and passes a change on to its parent
+        template<typename E, typename H>
+        void SmaStar<E, H>::backup(int index) {
+            while (index != NONE) {
+                auto &node = nodes_[index];
+                auto f = node.forgotten;
+                for (auto child : node.children)
+                    if (child != NONE)
+                        f = std::min(f, nodes_[child].f);
+                if (f == node.f)
+                    break;
+                node.f = f;
+                refresh(index);
+                index = node.parent;
+            }
+        }
+
+        template<typename E, typename H>
+        void SmaStar<E, H>::expand(int index) {
+            auto again = nodes_[index].expanded;
+            // Children lost before come back no cheaper than the lowest of them
+            auto bound = again ? nodes_[index].forgotten : nodes_[index].f;
+            nodes_[index].expanded = true;
+            nodes_[index].forgotten = INF;
+            expanding_ = index;
+            refresh(index);
+
+            ++stats_.expanded;
+            if (again)
+                ++stats_.reexpanded;
+            for (auto move = Move(); move != Move::IDLE; ++move) {
+                auto slot = static_cast<int>(move);
+                if (move == inverse(nodes_[index].move) || nodes_[index].children[slot] != NONE)
+                    continue;
+                auto state = nodes_[index].state;
+                if (!state.apply(move))
+                    continue;
+                ++stats_.generated;
+                if (!reserve())
+                    break;
+
+                auto child = allocate(state);
+                auto &node = nodes_[child];
+                node.parent = index;
+                node.move = move;
+                node.g = nodes_[index].g + 1;
+                // A node too deep to expand within the budget is a dead end unless it is the target
+                if (node.g + 1 + BRANCHES > static_cast<int>(capacity_) && !(state == target_))
+                    node.f = INF;
+                else
+                    node.f = std::max(node.g + h_(state), bound);
+                nodes_[index].children[slot] = child;
+                refresh(child);
+            }
+
+            expanding_ = NONE;
+            refresh(index);
+            backup(index);
+        }
+
+        template<typename E, typename H>
+        Path SmaStar<E, H>::tracePath(int index) const {
+            Path path(static_cast<std::size_t>(nodes_[index].g));
+            for (; nodes_[index].parent != NONE; index = nodes_[index].parent)
+                path.set(static_cast<std::size_t>(nodes_[index].g - 1), static_cast<int>(nodes_[index].move));
+            return path;
+        }
+    }
+
+    // Nodes smaStar() can hold in bytes of memory
+    template<typename E>
+    constexpr std::size_t smaStarCapacity(std::size_t bytes) {
+        return bytes / impl::SmaStar<E>::nodeBytes();
+    }
+
+    // A* that never holds more than max_nodes nodes, evicting the worst leaves when it runs out and
+    // expanding their parents again once they are the most promising. The solution is optimal as
+    // long as max_nodes exceeds its length by the branching factor, otherwise the search fails, as
+    // it does when the limits run out. stats().evicted and stats().reexpanded tell how much the
+    // budget cost.
+    template<typename E, typename H>
+    Result smaStar(const E &start, const E &target, H h, std::size_t max_nodes, const Limits &limits = Limits()) {
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        impl::SmaStar<E, H> search(target, std::move(h), max_nodes);
+        return search.run(start, limits);
+    }
+}
+
+#endif //NPUZZLE_BOUNDEDSEARCH_H
@@ -0,0 +1,207 @@
+#ifndef NPUZZLE_DISTANCETABLE_H
+#define NPUZZLE_DISTANCETABLE_H
+
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "GraphSearch.h"
+#include "MappedFile.h"
+#include "Ranking.h"
+
+namespace board {
+    // Distance to the target of every board that can reach it, 4 bits apiece indexed by
+    // Ranking::rankReachable(): 90720 bytes for the 8-puzzle, whose boards are at most 31 moves
+    // away. Only the distance modulo 16 is kept. A move changes the distance by exactly one, so
+    // the neighbour one move closer is still the one whose entry is one less, and following
+    // those neighbours gives an optimal solution and its length in as many lookups.
+    template<std::uint8_t N>
+    class DistanceTable {
+        static_assert(N <= 3, "the table has an entry for every reachable board");
+
+    public:
+        using Rank = Ranking<N>;
+
+        explicit DistanceTable(const Board<N> &target);
+
+        DistanceTable(const DistanceTable &rhs) = delete;
+
+        DistanceTable &operator=(const DistanceTable &rhs) = delete;
+
+        ~DistanceTable() = default;
+
+        // Maps a file written by save(), nullptr if it is missing or was built for another target
+        static std::unique_ptr<DistanceTable> load(const Board<N> &target, const std::string &path);
+
+        bool save(const std::string &path) const;
+
+        const Board<N> &target() const noexcept {
+            return target_;
+        }
+
+        // Moves from board to the target, -1 if it cannot be reached or the table is damaged
+        int distance(const Board<N> &board) const;
+
+        // An optimal solution, read off the table without searching
+        search::Result solve(const Board<N> &start) const;
+
+    private:
+        DistanceTable(const Board<N> &target, io::MappedFile &&file);
+
+        static constexpr std::uint8_t VERSION = 1;
+
+        static constexpr std::size_t HEADER = 8 + Board<N>::SIZE;
+
+        static constexpr std::size_t BYTES = (Rank::REACHABLE + 1) / 2;
+
+        // Moves to the target from the farthest board
+        static constexpr int MAX_DEPTH = N == 3 ? 31 : N == 2 ? 6 : 0;
+
+        int entry(const Board<N> &board) const noexcept {
+            auto rank = Rank::rankReachable(board);
+            return table_[rank / 2] >> (rank % 2 * 4) & 0xF;
+        }
+
+        // Walks from start to the target one move closer at a time, handing every move to visit;
+        // false if the table leads nowhere, as a damaged file would
+        template<typename Visit>
+        bool descend(const Board<N> &start, Visit &&visit) const;
+
+        Board<N> target_;
+        const std::uint8_t *table_ = nullptr;
+        std::vector<std::uint8_t> storage_;
+        io::MappedFile file_;
+    };
+
+    template<std::uint8_t N>
+    DistanceTable<N>::DistanceTable(const Board<N> &target) : target_(target), storage_(BYTES, 0) {
+        // Breadth first over ranks, one byte per board while it runs
+        std::vector<std::uint8_t> depth(Rank::REACHABLE, 0xFF);
+        const auto parity = target_.parity();
+        std::vector<std::uint64_t> current{Rank::rankReachable(target_)};
+        std::vector<std::uint64_t> next;
+        depth[current.front()] = 0;
+        for (std::uint8_t d = 0; !current.empty(); ++d) {
+            for (auto rank : current) {
+                auto board = Rank::unrankReachable(rank, parity);
+                board.expand([&](const Board<N> &neighbor, Move) {
+                    auto r = Rank::rankReachable(neighbor);
+                    if (depth[r] == 0xFF) {
+                        depth[r] = static_cast<std::uint8_t>(d + 1);
+                        next.push_back(r);
+                    }
+                });
+            }
+            current.swap(next);
+            next.clear();
+        }
+
+        for (std::uint64_t rank = 0; rank < Rank::REACHABLE; ++rank)
+            storage_[rank / 2] |= static_cast<std::uint8_t>((depth[rank] & 0xF) << (rank % 2 * 4));
+        table_ = storage_.data();
+    }
+
+    template<std::uint8_t N>
+    DistanceTable<N>::DistanceTable(const Board<N> &target, io::MappedFile &&file)
+            : target_(target), table_(file.data() + HEADER), file_(std::move(file)) {}
+
+    template<std::uint8_t N>
+    template<typename Visit>
+    bool DistanceTable<N>::descend(const Board<N> &start, Visit &&visit) const {
+        auto board = start;
+        auto d = entry(board);
+        for (int moves = 0; board != target_; ++moves) {
+            if (moves == MAX_DEPTH)
+                return false;
+            auto closer = (d + 15) & 0xF;
+            auto found = false;
+            for (auto move = Move::LEFT; move != Move::IDLE && !found; ++move) {
+                if (!board.moveBlank(move))
+                    continue;
+                if (entry(board) == closer) {
+                    visit(move);
+                    found = true;
+                } else {
+                    board.moveBlank(inverse(move));
+                }
+            }
+            if (!found)
+                return false;
+            d = closer;
+        }
+        return true;
+    }
+
+    template<std::uint8_t N>
+    int DistanceTable<N>::distance(const Board<N> &board) const {
+        if (!solvable(board, target_))
+            return -1;
+        int moves = 0;
+        if (!descend(board, [&moves](Move) {
+            ++moves;
+        }))
+            return -1;
+        return moves;
+    }
+
+    template<std::uint8_t N>
+    search::Result DistanceTable<N>::solve(const Board<N> &start) const {
+        if (!solvable(start, target_))
+            return {search::Result::UNSOLVABLE, 0};
+
+        search::impl::Stopwatch stopwatch;
+        search::Statistics stats;
+        std::vector<Move> moves;
+        if (!descend(start, [&moves](Move move) {
+            moves.push_back(move);
+        })) {
+            stopwatch.lap(stats, "lookup");
+            return {search::Result::FAILED, static_cast<std::int64_t>(moves.size() + 1), std::move(stats)};
+        }
+        search::Path path(moves.size());
+        for (std::size_t i = 0; i < moves.size(); ++i)
+            path.set(i, static_cast<int>(moves[i]));
+        stats.expanded = static_cast<std::int64_t>(moves.size());
+        stats.peak_memory = BYTES;
+        stopwatch.lap(stats, "lookup");
+        return {search::Result::SUCCESS, static_cast<std::int64_t>(moves.size() + 1), std::move(stats),
+                std::move(path)};
+    }
+
+    // File layout: "NPDT", version, N, two reserved bytes, the target pieces, then the table
+    template<std::uint8_t N>
+    bool DistanceTable<N>::save(const std::string &path) const {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os)
+            return false;
+
+        std::vector<std::uint8_t> header{'N', 'P', 'D', 'T', VERSION, N, 0, 0};
+        for (int i = 0; i < Board<N>::SIZE; ++i)
+            header.push_back(target_[i]);
+        os.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+        os.write(reinterpret_cast<const char *>(table_), static_cast<std::streamsize>(BYTES));
+        return static_cast<bool>(os);
+    }
+
+    template<std::uint8_t N>
+    std::unique_ptr<DistanceTable<N>> DistanceTable<N>::load(const Board<N> &target, const std::string &path) {
+        io::MappedFile file(path);
+        if (!file.isOpen())
+            return nullptr;
+
+        const auto *data = file.data();
+        if (file.size() != HEADER + BYTES || !std::equal(data, data + 4, "NPDT") || data[4] != VERSION ||
+            data[5] != N)
+            return nullptr;
+        for (int i = 0; i < Board<N>::SIZE; ++i)
+            if (data[8 + i] != target[i])
+                return nullptr;
+        return std::unique_ptr<DistanceTable>(new DistanceTable(target, std::move(file)));
+    }
+}
+
+#endif //NPUZZLE_DISTANCETABLE_H
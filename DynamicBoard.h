@@ -0,0 +1,239 @@
+#ifndef NPUZZLE_DYNAMICBOARD_H
+#define NPUZZLE_DYNAMICBOARD_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+
+namespace board {
+    class DynamicGoal;
+
+    // A board whose side is only known at run time, for the sizes past Board<N>'s: the grid is a
+    // vector, and the hash keys and move targets are computed rather than looked up in tables
+    // built for one size. Otherwise it keeps what Board<N> keeps and is searched the same way.
+    class DynamicBoard {
+    public:
+        using Piece = std::uint8_t;
+        using Move = board::Move;
+
+        // Every piece of a 15x15 board still fits a Piece
+        static constexpr int MAX_SIDE = 15;
+
+        // Stands for every piece whose place does not matter, in a board reduced to those that do
+        static constexpr Piece ANY = 0xFF;
+
+        // side * side pieces row by row, 0 for the blank
+        DynamicBoard(int side, std::vector<Piece> grid);
+
+        bool operator==(const DynamicBoard &rhs) const {
+            return hashcode_ == rhs.hashcode_ && grid_ == rhs.grid_;
+        }
+
+        bool operator!=(const DynamicBoard &rhs) const {
+            return !(rhs == *this);
+        }
+
+        const Piece &operator[](std::size_t n) const {
+            return grid_[n];
+        }
+
+        int side() const noexcept {
+            return side_;
+        }
+
+        int size() const noexcept {
+            return static_cast<int>(grid_.size());
+        }
+
+        std::size_t hashCode() const noexcept {
+            return hashcode_;
+        }
+
+        int blankIndex() const noexcept {
+            return blank_index_;
+        }
+
+        // Keeps manhattan() and misplaced() up to date against goal, which must outlive the board
+        void setGoal(const DynamicGoal &goal) noexcept;
+
+        const DynamicGoal *goal() const noexcept {
+            return goal_;
+        }
+
+        int manhattan() const noexcept {
+            return manhattan_;
+        }
+
+        int misplaced() const noexcept {
+            return misplaced_;
+        }
+
+        bool moveBlank(Move direction) noexcept;
+
+        // The move of the search engines, see GraphSearch.h
+        bool apply(Move direction) noexcept {
+            return moveBlank(direction);
+        }
+
+        // Cell the blank would move to, -1 if direction leads off the board
+        int neighbor(int index, Move direction) const noexcept {
+            switch (direction) {
+                case Move::LEFT:
+                    return index % side_ != 0 ? index - 1 : -1;
+                case Move::UP:
+                    return index >= side_ ? index - side_ : -1;
+                case Move::RIGHT:
+                    return index % side_ != side_ - 1 ? index + 1 : -1;
+                case Move::DOWN:
+                    return index < size() - side_ ? index + side_ : -1;
+                default:
+                    return -1;
+            }
+        }
+
+        // Same invariant as Board<N>::parity()
+        int parity() const noexcept;
+
+    private:
+        // Zobrist key of piece at index, hashed from both instead of read from a table
+        static std::uint64_t key(Piece piece, int index) noexcept {
+            std::uint64_t state = static_cast<std::uint64_t>(piece) << 16 | static_cast<std::uint64_t>(index);
+            return impl::splitmix64(state);
+        }
+
+        int side_;
+        std::vector<Piece> grid_;
+        std::size_t hashcode_ = 0;
+        int blank_index_ = 0;
+        const DynamicGoal *goal_ = nullptr;
+        int manhattan_ = 0;
+        int misplaced_ = 0;
+    };
+
+    // Target positions of the pieces of a DynamicBoard; distances are worked out from them on
+    // the spot, the tables Goal<N> keeps would not pay for themselves on boards this large
+    class DynamicGoal {
+    public:
+        using Piece = DynamicBoard::Piece;
+
+        explicit DynamicGoal(const DynamicBoard &target) : target_(target), index_(DynamicBoard::ANY + 1) {
+            for (int i = 0; i < target.size(); ++i)
+                index_[target[i]] = i;
+        }
+
+        const DynamicBoard &target() const noexcept {
+            return target_;
+        }
+
+        int index(Piece piece) const noexcept {
+            return index_[piece];
+        }
+
+        // Manhattan distance of piece at index from its target position, 0 for the blank and ANY
+        int distance(Piece piece, int index) const noexcept {
+            if (piece == 0 || piece == DynamicBoard::ANY)
+                return 0;
+            auto side = target_.side();
+            auto j = index_[piece];
+            return std::abs(index % side - j % side) + std::abs(index / side - j / side);
+        }
+
+        int misplaced(Piece piece, int index) const noexcept {
+            return piece != 0 && piece != DynamicBoard::ANY && target_[index] != piece;
+        }
+
+    private:
+        DynamicBoard target_;
+        std::vector<int> index_;
+    };
+
+    constexpr int DynamicBoard::MAX_SIDE;
+
+    constexpr DynamicBoard::Piece DynamicBoard::ANY;
+
+    inline DynamicBoard::DynamicBoard(int side, std::vector<Piece> grid) : side_(side), grid_(std::move(grid)) {
+        for (int i = 0; i < size(); ++i) {
+            if (grid_[i] == 0)
+                blank_index_ = i;
+            else
+                hashcode_ ^= key(grid_[i], i);
+        }
+    }
+
+    inline void DynamicBoard::setGoal(const DynamicGoal &goal) noexcept {
+        goal_ = &goal;
+        manhattan_ = 0;
+        misplaced_ = 0;
+        for (int i = 0; i < size(); ++i) {
+            manhattan_ += goal.distance(grid_[i], i);
+            misplaced_ += goal.misplaced(grid_[i], i);
+        }
+    }
+
+    inline bool DynamicBoard::moveBlank(Move direction) noexcept {
+        int next = neighbor(blank_index_, direction);
+        if (next < 0)
+            return false;
+
+        // The moved piece now sits where the blank was
+        auto piece = grid_[next];
+        grid_[blank_index_] = piece;
+        grid_[next] = 0;
+        hashcode_ ^= key(piece, next) ^ key(piece, blank_index_);
+        if (goal_) {
+            manhattan_ += goal_->distance(piece, blank_index_) - goal_->distance(piece, next);
+            misplaced_ += goal_->misplaced(piece, blank_index_) - goal_->misplaced(piece, next);
+        }
+        blank_index_ = next;
+        return true;
+    }
+
+    inline int DynamicBoard::parity() const noexcept {
+        int inversions = 0;
+        for (int i = 0; i < size(); ++i) {
+            if (grid_[i] == 0)
+                continue;
+            for (int j = i + 1; j < size(); ++j)
+                if (grid_[j] != 0 && grid_[j] < grid_[i])
+                    ++inversions;
+        }
+        if (side_ % 2 == 0)
+            inversions += blank_index_ / side_;
+        return inversions % 2;
+    }
+
+    // Swapping two ANY pieces changes the parity and nothing else, so with two of them either
+    // half will do
+    inline bool solvable(const DynamicBoard &start, const DynamicBoard &target) noexcept {
+        if (start.side() != target.side())
+            return false;
+        int any = 0;
+        for (int i = 0; i < start.size(); ++i)
+            any += start[i] == DynamicBoard::ANY;
+        return any >= 2 || start.parity() == target.parity();
+    }
+
+    inline std::ostream &operator<<(std::ostream &os, const DynamicBoard &board) {
+        for (int i = 0; i < board.size();) {
+            os << std::to_string(board[i]) << '\t';
+            if ((++i) % board.side() == 0)
+                os << '\n';
+        }
+        return os;
+    }
+}
+
+namespace std {
+    template<>
+    struct hash<board::DynamicBoard> {
+        std::size_t operator()(const board::DynamicBoard &board) const noexcept {
+            return board.hashCode();
+        }
+    };
+}
+
+#endif //NPUZZLE_DYNAMICBOARD_H
@@ -0,0 +1,405 @@
+#ifndef NPUZZLE_EXTERNALSEARCH_H
+#define NPUZZLE_EXTERNALSEARCH_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "GraphSearch.h"
+
+namespace search {
+    struct ExternalOptions {
+        // Existing directory the layer and run files are written to
+        std::string directory = ".";
+        // Bytes of generated states sorted in memory before they are spilled to a run file
+        std::size_t memory = std::size_t(256) << 20;
+        // Layers past this depth are not generated
+        std::size_t max_depth = std::numeric_limits<std::size_t>::max();
+        // Leave every layer file behind instead of only the two the search still needs
+        bool keep = false;
+    };
+
+    // Outcome of an enumeration: how many states lie at each distance from the start
+    struct Enumeration {
+        std::vector<std::uint64_t> layers;
+        Statistics stats;
+        // Bytes written to layer and run files
+        std::uint64_t written = 0;
+        // False if a file could not be written or read back, layers then stops at the last good one
+        bool complete = false;
+
+        std::uint64_t states() const {
+            std::uint64_t total = 0;
+            for (auto count : layers)
+                total += count;
+            return total;
+        }
+    };
+
+    namespace impl {
+        // Files are read and written in blocks of this many bytes
+        constexpr std::size_t IO_BLOCK = std::size_t(1) << 18;
+
+        // Strictly increasing packed states, each stored as the index of the first word that differs
+        // from the state before (omitted for single word states), the difference in that word and
+        // the words after it, all as LEB128 varints. Deep 15-puzzle layers take about 4 bytes a state.
+        template<typename Key>
+        class LayerWriter {
+        public:
+            static constexpr int WORDS = static_cast<int>(std::tuple_size<Key>::value);
+
+            explicit LayerWriter(const std::string &path) : os_(path, std::ios::binary | std::ios::trunc) {
+                buffer_.reserve(IO_BLOCK + 16 * (WORDS + 1));
+                buffer_.assign({'N', 'P', 'L', 'Y', VERSION, static_cast<std::uint8_t>(WORDS), 0, 0});
+                last_.fill(0);
+            }
+
+            bool isOpen() const {
+                return os_.is_open();
+            }
+
+            void write(const Key &key) {
+                int first = 0;
+                if (count_ != 0)
+                    while (first < WORDS - 1 && key[first] == last_[first])
+                        ++first;
+                if (WORDS > 1)
+                    buffer_.push_back(static_cast<std::uint8_t>(first));
+                put(key[first] - last_[first]);
+                for (int i = first + 1; i < WORDS; ++i)
+                    put(key[i]);
+                last_ = key;
+                ++count_;
+                if (buffer_.size() >= IO_BLOCK)
+                    flush();
+            }
+
+            bool close() {
+                flush();
+                os_.close();
+                return !os_.fail();
+            }
+
+            std::uint64_t count() const {
+                return count_;
+            }
+
+            std::uint64_t bytes() const {
+                return bytes_;
+            }
+
+        private:
+            static constexpr std::uint8_t VERSION = 1;
+
+            void put(std::uint64_t value) {
+                for (; value >= 0x80; value >>= 7)
+                    buffer_.push_back(static_cast<std::uint8_t>(value | 0x80));
+                buffer_.push_back(static_cast<std::uint8_t>(value));
+            }
+
+            void flush() {
+                os_.write(reinterpret_cast<const char *>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+                bytes_ += buffer_.size();
+                buffer_.clear();
+            }
+
+            std::ofstream os_;
+            std::vector<std::uint8_t> buffer_;
+            Key last_;
+            std::uint64_t count_ = 0;
+            std::uint64_t bytes_ = 0;
+        };
+
+        template<typename Key>
+        class LayerReader {
+        public:
+            static constexpr int WORDS = LayerWriter<Key>::WORDS;
+
+            // A missing path reads as an empty layer
+            explicit LayerReader(const std::string &path) : is_(path, std::ios::binary) {
+                last_.fill(0);
+                if (!is_.is_open())
+                    return;
+                std::uint8_t header[8] = {};
+                for (auto &byte : header)
+                    if (!get(byte))
+                        break;
+                failed_ = failed_ || !std::equal(header, header + 4, "NPLY") || header[5] != WORDS;
+            }
+
+            // Next state, false at the end of the file or on a malformed one
+            bool next(Key &key) {
+                if (failed_ || !more())
+                    return false;
+                std::uint8_t first = 0;
+                std::uint64_t value;
+                if ((WORDS > 1 && !get(first)) || first >= WORDS || !varint(value)) {
+                    failed_ = true;
+                    return false;
+                }
+                last_[first] += value;
+                for (int i = first + 1; i < WORDS; ++i) {
+                    if (!varint(value))
+                        return false;
+                    last_[i] = value;
+                }
+                key = last_;
+                return true;
+            }
+
+            bool failed() const {
+                return failed_;
+            }
+
+        private:
+            // Whether any byte is left, reading the next block if the buffer is used up
+            bool more() {
+                if (pos_ == size_) {
+                    buffer_.resize(IO_BLOCK);
+                    is_.read(reinterpret_cast<char *>(buffer_.data()), static_cast<std::streamsize>(IO_BLOCK));
+                    size_ = static_cast<std::size_t>(is_.gcount());
+                    pos_ = 0;
+                }
+                return pos_ != size_;
+            }
+
+            // A byte missing inside a state or the header makes the file malformed
+            bool get(std::uint8_t &byte) {
+                if (!more()) {
+                    failed_ = true;
+                    return false;
+                }
+                byte = buffer_[pos_++];
+                return true;
+            }
+
+            bool varint(std::uint64_t &value) {
+                value = 0;
+                std::uint8_t byte;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    if (!get(byte))
+                        return false;
+                    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0)
+                        return true;
+                }
+                failed_ = true;
+                return false;
+            }
+
+            std::ifstream is_;
+            std::vector<std::uint8_t> buffer_;
+            std::size_t pos_ = 0;
+            std::size_t size_ = 0;
+            Key last_;
+            bool failed_ = false;
+        };
+
+        // Sorted, duplicate free runs merged into one increasing stream
+        template<typename Key>
+        class RunMerger {
+        public:
+            explicit RunMerger(const std::vector<std::string> &paths) {
+                for (const auto &path : paths) {
+                    readers_.emplace_back(new LayerReader<Key>(path));
+                    pull(readers_.size() - 1);
+                }
+            }
+
+            // Next distinct state of all runs, false once they are exhausted
+            bool next(Key &key) {
+                if (heap_.empty())
+                    return false;
+                key = heap_.top().key;
+                while (!heap_.empty() && heap_.top().key == key) {
+                    auto run = heap_.top().run;
+                    heap_.pop();
+                    pull(run);
+                }
+                return true;
+            }
+
+            bool failed() const {
+                return std::any_of(readers_.begin(), readers_.end(),
+                                   [](const std::unique_ptr<LayerReader<Key>> &reader) {
+                                       return reader->failed();
+                                   });
+            }
+
+        private:
+            struct Head {
+                Key key;
+                std::size_t run;
+
+                bool operator>(const Head &rhs) const {
+                    return rhs.key < key;
+                }
+            };
+
+            void pull(std::size_t run) {
+                Key key;
+                if (readers_[run]->next(key))
+                    heap_.push({key, run});
+            }
+
+            std::vector<std::unique_ptr<LayerReader<Key>>> readers_;
+            std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap_;
+        };
+
+        // Whether a sorted layer holds key, for keys asked in increasing order
+        template<typename Key>
+        class LayerFilter {
+        public:
+            explicit LayerFilter(const std::string &path) : reader_(path) {
+                more_ = reader_.next(head_);
+            }
+
+            bool contains(const Key &key) {
+                while (more_ && head_ < key)
+                    more_ = reader_.next(head_);
+                return more_ && head_ == key;
+            }
+
+            bool failed() const {
+                return reader_.failed();
+            }
+
+        private:
+            LayerReader<Key> reader_;
+            Key head_;
+            bool more_ = false;
+        };
+    }
+
+    // Breadth first enumeration of every state reachable from start, held on disk rather than in
+    // memory. Each layer is a sorted, compressed file of packed states. The next one is generated
+    // by streaming the current layer, sorting its successors in memory-sized runs and merging the
+    // runs while dropping states found in the previous two layers; with moves that can be undone
+    // no successor lies further back. visit(state, depth) sees every state once, in increasing
+    // order of depth. E must construct from its pack().
+    template<typename E, typename Visit>
+    Enumeration externalBfs(const E &start, const ExternalOptions &options, Visit &&visit) {
+        using Key = typename E::Packed;
+        using Move = typename E::Move;
+
+        impl::Stopwatch stopwatch;
+        Enumeration enumeration;
+        auto &stats = enumeration.stats;
+        const auto capacity = std::max<std::size_t>(options.memory / sizeof(Key), 1);
+        std::vector<Key> buffer;
+        std::vector<std::string> runs;
+        std::size_t peak_runs = 0;
+
+        auto file = [&options](const char *kind, std::size_t index) {
+            return options.directory + "/" + kind + "-" + std::to_string(index) + ".bin";
+        };
+        auto remove = [](const std::string &path) {
+            std::remove(path.c_str());
+        };
+
+        // Sorts the buffer into a new run file
+        auto spill = [&]() {
+            std::sort(buffer.begin(), buffer.end());
+            runs.push_back(file("run", runs.size()));
+            impl::LayerWriter<Key> writer(runs.back());
+            auto end = std::unique(buffer.begin(), buffer.end());
+            for (auto iter = buffer.begin(); iter != end; ++iter)
+                writer.write(*iter);
+            buffer.clear();
+            auto closed = writer.close();
+            enumeration.written += writer.bytes();
+            return closed;
+        };
+
+        auto finish = [&](bool complete) {
+            for (const auto &run : runs)
+                remove(run);
+            auto depth = enumeration.layers.size();
+            if (!options.keep)
+                for (std::size_t i = depth > 2 ? depth - 2 : 0; i <= depth; ++i)
+                    remove(file("layer", i));
+            stats.peak_memory = buffer.capacity() * sizeof(Key) + (peak_runs + 3) * impl::IO_BLOCK;
+            enumeration.complete = complete;
+            return std::move(enumeration);
+        };
+
+        {
+            impl::LayerWriter<Key> writer(file("layer", 0));
+            writer.write(start.pack());
+            auto closed = writer.close();
+            enumeration.written += writer.bytes();
+            if (!closed)
+                return finish(false);
+        }
+        visit(start, 0);
+        enumeration.layers.push_back(1);
+        stats.peak_open = 1;
+        buffer.reserve(capacity);
+
+        for (std::size_t depth = 0; depth < options.max_depth; ++depth) {
+            auto generated = stats.generated;
+            impl::LayerReader<Key> layer(file("layer", depth));
+            Key key;
+            while (layer.next(key)) {
+                E state(key);
+                ++stats.expanded;
+                for (auto move = Move(); move != Move::IDLE; ++move) {
+                    if (!state.apply(move))
+                        continue;
+                    ++stats.generated;
+                    buffer.push_back(state.pack());
+                    state.apply(inverse(move));
+                    if (buffer.size() == capacity && !spill())
+                        return finish(false);
+                }
+            }
+            if (layer.failed() || (!buffer.empty() && !spill()))
+                return finish(false);
+            peak_runs = std::max(peak_runs, runs.size());
+
+            impl::RunMerger<Key> successors(runs);
+            impl::LayerFilter<Key> previous(depth == 0 ? std::string() : file("layer", depth - 1));
+            impl::LayerFilter<Key> current(file("layer", depth));
+            impl::LayerWriter<Key> writer(file("layer", depth + 1));
+            while (successors.next(key)) {
+                if (previous.contains(key) || current.contains(key))
+                    continue;
+                writer.write(key);
+                visit(E(key), static_cast<int>(depth + 1));
+            }
+            auto closed = writer.close();
+            enumeration.written += writer.bytes();
+            if (!closed || successors.failed() || previous.failed() || current.failed())
+                return finish(false);
+            stats.duplicates += stats.generated - generated - static_cast<std::int64_t>(writer.count());
+
+            for (const auto &run : runs)
+                remove(run);
+            runs.clear();
+            if (!options.keep && depth != 0)
+                remove(file("layer", depth - 1));
+            stopwatch.lap(stats, "layer");
+            if (writer.count() == 0)
+                break;
+            enumeration.layers.push_back(writer.count());
+            stats.peak_open = std::max(stats.peak_open, static_cast<std::size_t>(writer.count()));
+        }
+        stats.peak_closed = static_cast<std::size_t>(enumeration.states());
+        return finish(true);
+    }
+
+    template<typename E>
+    Enumeration externalBfs(const E &start, const ExternalOptions &options) {
+        return externalBfs(start, options, [](const E &, int) {});
+    }
+}
+
+#endif //NPUZZLE_EXTERNALSEARCH_H
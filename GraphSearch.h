@@ -1,119 +1,681 @@
 #ifndef NPUZZLE_GRAPHSEARCH_H
 #define NPUZZLE_GRAPHSEARCH_H
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <queue>
 #include <stack>
-#include <forward_list>
+#include <algorithm>
+#include <unordered_set>
 
 #include "Node.h"
 
+// Set to 0 to compile the node trace out of every engine
+#ifndef NPUZZLE_TRACE
+#define NPUZZLE_TRACE 1
+#endif
+
+// The engines search any state type E that provides, all resolved at compile time:
+//  - E::Move, an enumeration whose values from Move() up to Move::IDLE are the moves, at most
+//    four of them, with ++move and inverse(move) found by argument dependent lookup
+//  - bool apply(Move), which makes the move and returns true, or returns false and leaves the
+//    state alone where it does not apply; applying inverse(move) undoes it
+//  - operator== and std::hash<E>, for duplicate detection
+//  - optionally solvable(start, target), also found by argument dependent lookup
+// Successors are generated by applying each move to a copy of the state in a buffer the caller
+// owns, or in place and undone again by IDA*. Heuristics and evaluators are plain callables
+// taken as template arguments, so they inline into the hot loops; Evaluator and Heuristic are
+// their type erased forms for callers that need one.
 namespace search {
+    // How many of the nodes they reach the engines print, see setTrace()
+    enum class Trace {
+        OFF, SAMPLED, FULL
+    };
+
+    // Counters of one search, sizes and memory are the largest reached while it ran
+    struct Statistics {
+        struct Phase {
+            const char *name;
+            double seconds;
+        };
+
+        // Nodes whose children were generated, children generated, and children dropped as known states
+        std::int64_t expanded = 0;
+        std::int64_t generated = 0;
+        std::int64_t duplicates = 0;
+        // Nodes a memory bounded search dropped to stay in its budget, and expansions of nodes
+        // whose children it had dropped
+        std::int64_t evicted = 0;
+        std::int64_t reexpanded = 0;
+        std::size_t peak_open = 0;
+        std::size_t peak_closed = 0;
+        // Bytes held by the nodes and containers of the search
+        std::size_t peak_memory = 0;
+        std::vector<Phase> phases;
+
+        double seconds() const {
+            double total = 0;
+            for (const auto &phase : phases)
+                total += phase.seconds;
+            return total;
+        }
+    };
+
     namespace impl {
         template<typename E>
-        using Filter = std::function<bool(const NodePtr <E> &)>;
+        inline bool isNotSameWithAncestors(const Node <E> &node) {
+            for (auto parent = node.getParent(); parent != nullptr; parent = parent->getParent())
+                if (node == *parent)
+                    return false;
+            return true;
+        }
 
         template<typename E>
-        inline bool isNotSameWithAncestors(const NodePtr <E> &node) {
-            for (auto parent = node->getParent(); parent != nullptr; parent = parent->getParent())
-                if (*node == *parent)
-                    return false;
+        inline bool acceptAll(const Node <E> &) {
             return true;
         }
 
+        // Fills children with copies of node moved one step each way, children keeps its capacity
+        // between calls so expanding allocates nothing; only the kept ones are copied into the pool.
         template<typename E>
-        std::vector<NodePtr<E>> expand(const NodePtr <E> &node, Filter<E> filter) {
-            auto children = node->expand();
-            std::vector<NodePtr<E>> result;
-            result.reserve(4);
-            for (auto &child : children) {
-                child->setParent(node);
-                child->setDepth(node->getDepth() + 1);
-                if (filter(child)) {
-                    result.push_back(std::move(child));
+        void expand(const NodePtr <E> &node, std::vector<Node<E>> &children) {
+            using Move = typename E::Move;
+            children.clear();
+            for (auto move = Move(); move != Move::IDLE; ++move) {
+                children.emplace_back(node->get(), node, node->getDepth() + 1);
+                if (!children.back().get().apply(move)) {
+                    children.pop_back();
                 }
             }
-            return result;
+        }
+
+        // Returns how many children filter dropped
+        template<typename E, typename Filter>
+        std::size_t expand(const NodePtr <E> &node, Filter filter, std::vector<Node<E>> &children) {
+            expand(node, children);
+            auto kept = std::remove_if(children.begin(), children.end(), [&filter](const Node<E> &child) {
+                return !filter(child);
+            });
+            auto dropped = static_cast<std::size_t>(children.end() - kept);
+            children.erase(kept, children.end());
+            return dropped;
         }
 
         template<typename E>
-        inline bool check(const NodePtr <E> &node, const NodePtr <E> &target) {
-            return *node == *target;
+        inline bool check(const Node <E> &node, const E &target) {
+            return node.get() == target;
         }
 
+        struct TraceSettings {
+            std::atomic<Trace> level{Trace::OFF};
+            std::ostream *os = &std::cout;
+            std::int64_t interval = 1;
+            std::mutex mutex;
+        };
+
+        inline TraceSettings &traceSettings() {
+            static TraceSettings settings;
+            return settings;
+        }
+
+        // For engines that keep states without a Node around them
         template<typename E>
-        inline void log(std::int64_t step, const NodePtr <E> &node) {
-            std::cout << "step " << step << std::endl;
-            std::cout << "depth " << node->getDepth() << std::endl;
-            std::cout << node->get() << std::endl;
+        inline void log(std::int64_t step, const E &state, int depth) {
+#if NPUZZLE_TRACE
+            auto &settings = traceSettings();
+            auto level = settings.level.load(std::memory_order_relaxed);
+            if (level == Trace::OFF || (level == Trace::SAMPLED && step % settings.interval != 0)) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(settings.mutex);
+            *settings.os << "step " << step << '\n' << "depth " << depth << '\n' << state << '\n';
+#else
+            (void) step;
+            (void) state;
+            (void) depth;
+#endif
         }
+
+        template<typename E>
+        inline void log(std::int64_t step, const Node <E> &node) {
+            log(step, node.get(), node.getDepth());
+        }
+
+        // Splits the wall time of a search into named phases
+        class Stopwatch {
+        public:
+            Stopwatch() : begin_(std::chrono::steady_clock::now()) {}
+
+            void lap(Statistics &stats, const char *phase) {
+                auto now = std::chrono::steady_clock::now();
+                stats.phases.push_back({phase, std::chrono::duration<double>(now - begin_).count()});
+                begin_ = now;
+            }
+
+        private:
+            std::chrono::steady_clock::time_point begin_;
+        };
+
+        // States already generated, looked up by the hash of their element
+        template<typename E>
+        using NodeTable = std::unordered_set<NodePtr<E>, NodeHash<E>, NodeEqual<E>>;
+
+        // Bucket array plus one list node (next pointer, value, cached hash) per element
+        template<typename E>
+        inline std::size_t memory(const NodeTable<E> &table) {
+            return table.bucket_count() * sizeof(void *) +
+                   table.size() * (sizeof(void *) + sizeof(NodePtr<E>) + sizeof(std::size_t));
+        }
+
+        // Binary heap ordered by cost with lazy deletion: a node whose cost is lowered
+        // is pushed again and the outdated entry is dropped when it reaches the top.
+        template<typename E>
+        class OpenList {
+        public:
+            bool empty() const {
+                return heap_.empty();
+            }
+
+            std::size_t size() const {
+                return heap_.size();
+            }
+
+            std::size_t memory() const {
+                return heap_.capacity() * sizeof(Entry);
+            }
+
+            // Empties the heap but keeps its storage
+            void clear() {
+                heap_.clear();
+            }
+
+            void push(const NodePtr <E> &node) {
+                heap_.push_back({node->getCost(), node->getDepth(), node});
+                std::push_heap(heap_.begin(), heap_.end(), Compare{});
+            }
+
+            NodePtr <E> pop() {
+                while (!heap_.empty()) {
+                    std::pop_heap(heap_.begin(), heap_.end(), Compare{});
+                    auto entry = heap_.back();
+                    heap_.pop_back();
+                    if (entry.cost == entry.node->getCost()) {
+                        return entry.node;
+                    }
+                }
+                return nullptr;
+            }
+
+            // The node pop() would return, left in the heap
+            NodePtr <E> peek() {
+                while (!heap_.empty() && heap_.front().cost != heap_.front().node->getCost()) {
+                    std::pop_heap(heap_.begin(), heap_.end(), Compare{});
+                    heap_.pop_back();
+                }
+                return heap_.empty() ? nullptr : heap_.front().node;
+            }
+
+            // Drops the stale entries, gives every node left the cost cost(node) and heaps them again
+            template<typename F>
+            void reorder(F cost) {
+                auto kept = heap_.begin();
+                for (auto &entry : heap_) {
+                    if (entry.cost != entry.node->getCost())
+                        continue;
+                    entry.node->setCost(cost(entry.node));
+                    entry.cost = entry.node->getCost();
+                    *kept++ = entry;
+                }
+                heap_.erase(kept, heap_.end());
+                std::make_heap(heap_.begin(), heap_.end(), Compare{});
+            }
+
+        private:
+            struct Entry {
+                int cost;
+                int depth;
+                NodePtr <E> node;
+            };
+
+            // Lowest cost first, ties broken in favour of the deeper node
+            struct Compare {
+                bool operator()(const Entry &lhs, const Entry &rhs) const {
+                    return lhs.cost > rhs.cost || (lhs.cost == rhs.cost && lhs.depth < rhs.depth);
+                }
+            };
+
+            std::vector<Entry> heap_;
+        };
+    }
+
+    // Traces the nodes the engines reach to os: all of them, every interval-th step, or none,
+    // which is the default. Change it between searches, not while one is running.
+    inline void setTrace(Trace level, std::ostream &os = std::cout, std::int64_t interval = 1) {
+        auto &settings = impl::traceSettings();
+        std::lock_guard<std::mutex> lock(settings.mutex);
+        settings.os = &os;
+        settings.interval = interval > 0 ? interval : 1;
+        settings.level.store(level);
     }
 
+    // Where a running search is, see Limits::progress
+    struct Progress {
+        // The f value being searched: of the node expanded by the best-first engines, the
+        // threshold of the iteration for IDA*, the depth of the layer for beam search
+        int bound;
+        std::int64_t expanded;
+    };
+
+    // What a search may spend, nothing is limited unless set. A search that runs out or is
+    // cancelled fails, or returns the best solution it has if it keeps one.
+    struct Limits {
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point deadline = Clock::time_point::max();
+        std::int64_t max_expanded = std::numeric_limits<std::int64_t>::max();
+        // Set from any thread to stop the search
+        const std::atomic<bool> *cancel = nullptr;
+        // Called on the searching thread about every progress_interval expansions, at most every
+        // CLOCK_INTERVAL
+        std::function<void(const Progress &)> progress;
+        std::int64_t progress_interval = std::int64_t(1) << 16;
+
+        // A deadline duration from now
+        static Limits within(Clock::duration duration) {
+            Limits limits;
+            limits.deadline = Clock::now() + duration;
+            return limits;
+        }
+
+        // Called by the engines before every expansion, which is also when progress is reported.
+        // The clock, the cancel flag and progress wait for every CLOCK_INTERVAL-th expansion.
+        bool exceeded(std::int64_t expanded, int bound = 0) const {
+            if (expanded >= max_expanded)
+                return true;
+            if (expanded % CLOCK_INTERVAL != 0)
+                return false;
+            if (progress && (progress_interval <= CLOCK_INTERVAL || expanded % progress_interval < CLOCK_INTERVAL))
+                progress({bound, expanded});
+            return (cancel && cancel->load(std::memory_order_relaxed)) ||
+                   (deadline != Clock::time_point::max() && Clock::now() >= deadline);
+        }
+
+        bool cancelled() const {
+            return cancel && cancel->load(std::memory_order_relaxed);
+        }
+
+        static constexpr std::int64_t CLOCK_INTERVAL = 256;
+    };
+
+    // Containers of a best-first search kept from one search to the next, so a thread solving
+    // many instances reuses their memory instead of allocating it again for each one
+    template<typename E>
+    struct Workspace {
+        NodePool<E> pool;
+        impl::OpenList<E> open;
+        impl::NodeTable<E> table;
+        std::vector<Node<E>> children;
+
+        void clear() {
+            open.clear();
+            table.clear();
+            children.clear();
+            pool.clear();
+        }
+
+        std::size_t memory() const {
+            return pool.memory() + open.memory() + impl::memory<E>(table) + children.capacity() * sizeof(Node<E>);
+        }
+    };
+
+    // Moves of a solution from the start to the target, packed four to a byte. A move is stored
+    // as the value of the E::Move it was made with, so E::Move can have at most four moves.
+    class Path {
+    public:
+        Path() = default;
+
+        explicit Path(std::size_t size) : bytes_((size + 3) / 4, 0), size_(size) {}
+
+        std::size_t size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        int operator[](std::size_t i) const {
+            return (bytes_[i / 4] >> (i % 4 * 2)) & 3;
+        }
+
+        void set(std::size_t i, int move) {
+            auto shift = i % 4 * 2;
+            bytes_[i / 4] = static_cast<std::uint8_t>((bytes_[i / 4] & ~(3 << shift)) | (move & 3) << shift);
+        }
+
+        template<typename Move>
+        std::vector<Move> moves() const {
+            std::vector<Move> moves(size_);
+            for (std::size_t i = 0; i < size_; ++i)
+                moves[i] = static_cast<Move>((*this)[i]);
+            return moves;
+        }
+
+    private:
+        std::vector<std::uint8_t> bytes_;
+        std::size_t size_ = 0;
+    };
+
     class Result {
     public:
         enum results {
             SUCCESS = 0,
-            FAILED = 1
+            FAILED = 1,
+            // The target is not reachable from the start, detected before searching
+            UNSOLVABLE = 2
         };
 
         Result() : result_(FAILED), steps_(0) {}
 
         Result(results result, std::int64_t steps) : result_(result), steps_(steps) {}
 
+        Result(results result, std::int64_t steps, Statistics stats, Path path = {})
+                : result_(result), steps_(steps), stats_(std::move(stats)), path_(std::move(path)) {}
+
         bool success() const {
             return result_ == SUCCESS;
         }
 
+        bool unsolvable() const {
+            return result_ == UNSOLVABLE;
+        }
+
+        results status() const {
+            return static_cast<results>(result_);
+        }
+
         std::int64_t steps() const {
             return steps_;
         }
 
+        const Statistics &stats() const {
+            return stats_;
+        }
+
+        // Moves of the solution found, empty when there is none or start is the target
+        const Path &path() const {
+            return path_;
+        }
+
+        std::size_t length() const {
+            return path_.size();
+        }
+
     private:
-        std::uint64_t result_: 1;
-        std::uint64_t steps_: 63;
+        std::uint64_t result_: 2;
+        std::uint64_t steps_: 62;
+        Statistics stats_;
+        Path path_;
     };
 
     template<typename E>
     using Evaluator = std::function<int(const Node <E> &)>;
 
+    template<typename E>
+    using Heuristic = std::function<int(const E &)>;
+
+    namespace impl {
+        // Any element converts to it, so the solvable() of a domain found by argument dependent
+        // lookup is always the better match, and elements without one are assumed solvable
+        struct AnyElement {
+            template<typename E>
+            AnyElement(const E &) {}
+        };
+
+        inline bool solvable(AnyElement, AnyElement) {
+            return true;
+        }
+
+        template<typename E>
+        bool reachable(const E &start, const E &target) {
+            return solvable(start, target);
+        }
+
+        // The move taking from to to, they are one move apart
+        template<typename E>
+        int moveBetween(const E &from, const E &to) {
+            using Move = typename E::Move;
+            for (auto move = Move(); move != Move::IDLE; ++move) {
+                auto next = from;
+                if (next.apply(move) && next == to)
+                    return static_cast<int>(move);
+            }
+            return 0;
+        }
+
+        // Follows the parents of goal back to the start, only once the search is over
+        template<typename E>
+        Path tracePath(const Node <E> &goal) {
+            std::size_t length = 0;
+            for (auto node = &goal; node->getParent() != nullptr; node = node->getParent())
+                ++length;
+            Path path(length);
+            auto node = &goal;
+            for (auto i = length; i-- > 0; node = node->getParent())
+                path.set(i, moveBetween(node->getParent()->get(), node->get()));
+            return path;
+        }
+
+        // Joins the path from the start to a state with the path from the target to the same state
+        template<typename E>
+        Path joinPaths(const Path &forward, const Path &backward) {
+            using Move = typename E::Move;
+            Path path(forward.size() + backward.size());
+            for (std::size_t i = 0; i < forward.size(); ++i)
+                path.set(i, forward[i]);
+            for (std::size_t i = 0; i < backward.size(); ++i)
+                path.set(forward.size() + i,
+                         static_cast<int>(inverse(static_cast<Move>(backward[backward.size() - 1 - i]))));
+            return path;
+        }
+
+        // One side of a bidirectional search: the states it reached and its last layer
+        template<typename E>
+        struct Frontier {
+            explicit Frontier(const E &root) {
+                auto node = pool.create(root);
+                table.insert(node);
+                layer.push_back(node);
+            }
+
+            std::size_t memory() const {
+                return pool.memory() + impl::memory<E>(table) +
+                       (layer.capacity() + next.capacity()) * sizeof(NodePtr<E>);
+            }
+
+            NodePool<E> pool;
+            NodeTable<E> table;
+            std::vector<NodePtr<E>> layer;
+            std::vector<NodePtr<E>> next;
+        };
+
+        // One bounded depth-first pass of IDA*, moving the blank of current in place and back;
+        // stopped is set when the limits run out
+        template<typename E, typename H>
+        bool idaSearch(E &current, const E &target, const H &h, int g, int bound,
+                       typename E::Move last, std::int64_t &steps, int &next_bound, Statistics &stats,
+                       Path &path, const Limits &limits, bool &stopped) {
+            ++steps;
+            auto f = g + h(current);
+            if (f > bound) {
+                next_bound = std::min(next_bound, f);
+                return false;
+            }
+            if (current == target) {
+                // The path is sized here and filled in as the recursion unwinds
+                path = Path(static_cast<std::size_t>(g));
+                return true;
+            }
+            if (limits.exceeded(stats.expanded, bound)) {
+                stopped = true;
+                return false;
+            }
+
+            ++stats.expanded;
+            stats.peak_open = std::max(stats.peak_open, static_cast<std::size_t>(g + 1));
+            using Move = typename E::Move;
+            for (auto move = Move(); move != Move::IDLE; ++move) {
+                if (move == inverse(last) || !current.apply(move)) {
+                    continue;
+                }
+                ++stats.generated;
+                auto found = idaSearch(current, target, h, g + 1, bound, move, steps, next_bound, stats, path,
+                                       limits, stopped);
+                current.apply(inverse(move));
+                if (found) {
+                    path.set(static_cast<std::size_t>(g), static_cast<int>(move));
+                    return true;
+                }
+                if (stopped) {
+                    return false;
+                }
+            }
+            return false;
+        }
+    }
+
+    // Each state is reached at most once, the first time being along a shortest path
     template<typename E>
     Result bfs(const E &start, const E &target) {
         if (start == target) {
             return {Result::SUCCESS, 0};
         }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
 
-        auto ps = std::make_shared<Node<E>>(start);
-        auto pt = std::make_shared<Node<E>>(target);
+        impl::Stopwatch stopwatch;
+        Statistics stats;
+        NodePool<E> pool;
         std::queue<NodePtr<E>> open;
-        std::vector<NodePtr<E>> closed;
+        impl::NodeTable<E> visited;
+        std::vector<Node<E>> children;
         std::int64_t steps = 0;
 
+        auto finish = [&](Result::results result, const Node<E> *goal) {
+            stats.peak_closed = visited.size() - open.size();
+            stats.peak_memory = pool.memory() + impl::memory<E>(visited) + stats.peak_open * sizeof(NodePtr<E>) +
+                                children.capacity() * sizeof(Node<E>);
+            stopwatch.lap(stats, "search");
+            return Result(result, steps, std::move(stats), goal ? impl::tracePath(*goal) : Path());
+        };
+
+        auto ps = pool.create(start);
         ++steps;
-        impl::log(steps, ps);
-        if (impl::check(ps, pt)) {
-            return {Result::SUCCESS, steps};
+        impl::log(steps, *ps);
+        if (impl::check(*ps, target)) {
+            return finish(Result::SUCCESS, ps);
         }
 
+        visited.insert(ps);
         open.push(ps);
         while (!open.empty()) {
-            closed.push_back(open.front());
+            auto pn = open.front();
             open.pop();
 
-            auto pn = closed.back();
-            auto children = impl::expand(pn, impl::isNotSameWithAncestors<E>);
+            ++stats.expanded;
+            impl::expand(pn, children);
+            stats.generated += static_cast<std::int64_t>(children.size());
             for (auto &child : children) {
+                if (visited.count(&child) != 0) {
+                    ++stats.duplicates;
+                    continue;
+                }
                 ++steps;
                 impl::log(steps, child);
-                if (impl::check(child, pt)) {
-                    return {Result::SUCCESS, steps};
+                if (impl::check(child, target)) {
+                    return finish(Result::SUCCESS, &child);
                 }
-                open.push(child);
+                auto node = pool.create(child);
+                visited.insert(node);
+                open.push(node);
             }
+            stats.peak_open = std::max(stats.peak_open, open.size());
+        }
 
+        return finish(Result::FAILED, nullptr);
+    }
+
+    // Breadth first from both ends at once, a layer at a time from whichever side has the smaller
+    // frontier, until a state generated by one side is known to the other. Moves must be
+    // reversible, the target side walks them backwards.
+    template<typename E>
+    Result bidirectionalBfs(const E &start, const E &target) {
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        impl::Stopwatch stopwatch;
+        Statistics stats;
+        impl::Frontier<E> forward(start);
+        impl::Frontier<E> backward(target);
+        std::vector<Node<E>> children;
+        std::int64_t steps = 0;
+        const Node<E> *meet_forward = nullptr;
+        const Node<E> *meet_backward = nullptr;
+        auto best = std::numeric_limits<int>::max();
+
+        while (!forward.layer.empty() && !backward.layer.empty() && !meet_forward) {
+            auto forward_turn = forward.layer.size() <= backward.layer.size();
+            auto &side = forward_turn ? forward : backward;
+            auto &other = forward_turn ? backward : forward;
+
+            side.next.clear();
+            for (auto pn : side.layer) {
+                ++stats.expanded;
+                impl::expand(pn, children);
+                stats.generated += static_cast<std::int64_t>(children.size());
+                for (auto &child : children) {
+                    if (side.table.count(&child) != 0) {
+                        ++stats.duplicates;
+                        continue;
+                    }
+                    ++steps;
+                    impl::log(steps, child);
+                    auto node = side.pool.create(child);
+                    side.table.insert(node);
+                    side.next.push_back(node);
+
+                    // The layer is finished before stopping, a later meeting in it may be shorter
+                    auto iter = other.table.find(node);
+                    if (iter != other.table.end() && node->getDepth() + (*iter)->getDepth() < best) {
+                        best = node->getDepth() + (*iter)->getDepth();
+                        meet_forward = forward_turn ? node : *iter;
+                        meet_backward = forward_turn ? *iter : node;
+                    }
+                }
+            }
+            side.layer.swap(side.next);
+            stats.peak_open = std::max(stats.peak_open, forward.layer.size() + backward.layer.size());
         }
 
-        return {Result::FAILED, steps};
+        stats.peak_closed = forward.table.size() + backward.table.size() - forward.layer.size() - backward.layer.size();
+        stats.peak_memory = forward.memory() + backward.memory() + children.capacity() * sizeof(Node<E>);
+        stopwatch.lap(stats, "search");
+        if (!meet_forward) {
+            return {Result::FAILED, steps, std::move(stats)};
+        }
+        return {Result::SUCCESS, steps, std::move(stats), impl::joinPaths<E>(impl::tracePath(*meet_forward),
+                                                                             impl::tracePath(*meet_backward))};
     }
 
     template<typename E>
@@ -121,149 +683,282 @@ namespace search {
         if (start == target) {
             return {Result::SUCCESS, 0};
         }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
 
-        auto ps = std::make_shared<Node<E>>(start);
-        auto pt = std::make_shared<Node<E>>(target);
+        impl::Stopwatch stopwatch;
+        Statistics stats;
+        NodePool<E> pool;
         std::stack<NodePtr<E>> open;
-        std::vector<NodePtr<E>> closed;
+        std::vector<Node<E>> children;
         std::int64_t steps = 0;
 
-        open.push(ps);
+        auto finish = [&](Result::results result, const Node<E> *goal) {
+            stats.peak_closed = pool.size() - open.size();
+            stats.peak_memory = pool.memory() + stats.peak_open * sizeof(NodePtr<E>) +
+                                children.capacity() * sizeof(Node<E>);
+            stopwatch.lap(stats, "search");
+            return Result(result, steps, std::move(stats), goal ? impl::tracePath(*goal) : Path());
+        };
+
+        open.push(pool.create(start));
         while (!open.empty()) {
-            closed.push_back(open.top());
+            auto pn = open.top();
             open.pop();
 
-            auto pn = closed.back();
-
             ++steps;
-            impl::log(steps, pn);
-            if (impl::check(pn, pt)) {
-                return {Result::SUCCESS, steps};
+            impl::log(steps, *pn);
+            if (impl::check(*pn, target)) {
+                return finish(Result::SUCCESS, pn);
             }
 
-            if (pn->getDepth() < max_depth) {
-                auto children = impl::expand(pn, impl::isNotSameWithAncestors<E>);
+            if (static_cast<std::size_t>(pn->getDepth()) < max_depth) {
+                ++stats.expanded;
+                auto dropped = impl::expand(pn, impl::isNotSameWithAncestors<E>, children);
+                stats.generated += static_cast<std::int64_t>(children.size() + dropped);
+                stats.duplicates += static_cast<std::int64_t>(dropped);
                 for (auto iter = children.rbegin(); iter != children.rend(); ++iter) {
-                    if ((*iter)->getDepth() != max_depth) {
-                        open.push(*iter);
+                    if (static_cast<std::size_t>(iter->getDepth()) != max_depth) {
+                        open.push(pool.create(*iter));
                     } else {
                         impl::log(steps, *iter);
-                        if (impl::check(*iter, pt)) {
-                            return {Result::SUCCESS, steps};
+                        if (impl::check(*iter, target)) {
+                            return finish(Result::SUCCESS, &*iter);
                         }
                     }
                 }
+                stats.peak_open = std::max(stats.peak_open, open.size());
             }
         }
 
-        return {Result::FAILED, steps};
+        return finish(Result::FAILED, nullptr);
     }
 
-    template<typename E>
-    Result bestFS(const E &start, const E &target, Evaluator<E> evaluator) {
+    template<typename E, typename F>
+    Result bestFS(const E &start, const E &target, F evaluator, Workspace<E> &workspace) {
         if (start == target) {
             return {Result::SUCCESS, 0};
         }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
 
-        auto ps = std::make_shared<Node<E>>(start);
-        auto pt = std::make_shared<Node<E>>(target);
-        std::forward_list<NodePtr<E>> open;
-        std::forward_list<NodePtr<E>> closed;
+        impl::Stopwatch stopwatch;
+        Statistics stats;
+        workspace.clear();
+        auto &pool = workspace.pool;
+        auto &open = workspace.open;
+        auto &table = workspace.table;
+        auto &children = workspace.children;
         std::int64_t steps = 0;
+        stopwatch.lap(stats, "setup");
 
-        open.push_front(ps);
-        while (!open.empty()) {
-            open.sort([](const NodePtr<E> &lhs, const NodePtr<E> &rhs) {
-                return lhs->getCost() < rhs->getCost();
-            });
-            closed.push_front(open.front());
-            open.pop_front();
+        auto finish = [&](Result::results result, const Node<E> *goal) {
+            stats.peak_closed = table.size();
+            stats.peak_memory = workspace.memory();
+            stopwatch.lap(stats, "search");
+            return Result(result, steps, std::move(stats), goal ? impl::tracePath(*goal) : Path());
+        };
 
-            auto pn = closed.front();
-            auto depth = pn->getDepth();
+        auto ps = pool.create(start);
+        ps->setCost(evaluator(*ps));
+        open.push(ps);
+        table.insert(ps);
+        while (!open.empty()) {
+            auto pn = open.pop();
+            if (!pn) {
+                break;
+            }
 
             ++steps;
-            impl::log(steps, pn);
+            impl::log(steps, *pn);
 
-            if (impl::check(pn, pt)) {
-                return {Result::SUCCESS, steps};;
+            if (impl::check(*pn, target)) {
+                return finish(Result::SUCCESS, pn);
             }
 
-            auto children = impl::expand(pn, impl::isNotSameWithAncestors<E>);
+            ++stats.expanded;
+            impl::expand(pn, children);
+            stats.generated += static_cast<std::int64_t>(children.size());
             for (auto &child : children) {
-                auto cost = evaluator(*child);
-                auto iter = find(open.begin(), open.end(), child);
-                if (iter != open.end() && cost < (*iter)->getCost()) {
-                    (*iter)->setParent(pn);
-                    (*iter)->setCost(cost);
-                } else if ((iter = find(closed.begin(), closed.end(), child)) != closed.end() &&
-                           cost < (*iter)->getCost()) {
-                    (*iter)->setParent(pn);
-                    (*iter)->setCost(cost);
-                    open.push_front(*iter);
-                    closed.remove(*iter);
+                auto cost = evaluator(child);
+                auto iter = table.find(&child);
+                if (iter == table.end()) {
+                    child.setCost(cost);
+                    auto node = pool.create(child);
+                    open.push(node);
+                    table.insert(node);
+                } else if (cost < (*iter)->getCost()) {
+                    auto old = *iter;
+                    old->setParent(pn);
+                    old->setDepth(child.getDepth());
+                    old->setCost(cost);
+                    open.push(old);
                 } else {
-                    child->setCost(cost);
-                    open.push_front(child);
+                    ++stats.duplicates;
                 }
             }
+            stats.peak_open = std::max(stats.peak_open, open.size());
         }
-        return {Result::FAILED, steps};
+        return finish(Result::FAILED, nullptr);
     }
 
-    template<typename E>
-    Result aStar(const E &start, const E &target, Evaluator<E> g, Evaluator<E> h) {
+    template<typename E, typename F>
+    Result bestFS(const E &start, const E &target, F evaluator) {
+        Workspace<E> workspace;
+        return bestFS(start, target, std::move(evaluator), workspace);
+    }
+
+    template<typename E, typename G, typename H>
+    Result aStar(const E &start, const E &target, G g, H h, Workspace<E> &workspace,
+                 const Limits &limits = Limits()) {
         if (start == target) {
             return {Result::SUCCESS, 0};
         }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
 
-        auto ps = std::make_shared<Node<E>>(start);
-        auto pt = std::make_shared<Node<E>>(target);
-        std::forward_list<NodePtr<E>> open;
-        std::forward_list<NodePtr<E>> closed;
+        impl::Stopwatch stopwatch;
+        Statistics stats;
+        workspace.clear();
+        auto &pool = workspace.pool;
+        auto &open = workspace.open;
+        auto &table = workspace.table;
+        auto &children = workspace.children;
         std::int64_t steps = 0;
+        stopwatch.lap(stats, "setup");
 
-        open.push_front(ps);
-        while (!open.empty()) {
-            open.sort([](const NodePtr<E> &lhs, const NodePtr<E> &rhs) {
-                return lhs->getCost() < rhs->getCost();
-            });
-            closed.push_front(open.front());
-            open.pop_front();
+        auto finish = [&](Result::results result, const Node<E> *goal) {
+            stats.peak_closed = table.size();
+            stats.peak_memory = workspace.memory();
+            stopwatch.lap(stats, "search");
+            return Result(result, steps, std::move(stats), goal ? impl::tracePath(*goal) : Path());
+        };
 
-            auto pbn = closed.front();
+        auto ps = pool.create(start);
+        ps->setCost(g(*ps) + h(*ps));
+        open.push(ps);
+        table.insert(ps);
+        while (!open.empty()) {
+            auto pbn = open.pop();
+            if (!pbn) {
+                break;
+            }
 
             ++steps;
-            impl::log(steps, pbn);
+            impl::log(steps, *pbn);
 
-            if (impl::check(pbn, pt)) {
-                return {Result::SUCCESS, steps};
+            if (impl::check(*pbn, target)) {
+                return finish(Result::SUCCESS, pbn);
+            }
+            if (limits.exceeded(stats.expanded, pbn->getCost())) {
+                break;
             }
 
-            auto children = impl::expand(pbn, impl::isNotSameWithAncestors<E>);
-            for (auto it = children.begin(); it != children.end(); ++it) {
-                auto &child = *it;
-                auto hv = h(*child);
-                auto iter = find(open.begin(), open.end(), child);
-                if (iter != open.end() && g(*child) < g(*(*iter))) {
-                    auto &old = *iter;
-                    old->setParent(pbn);
-                    old->setCost(g(*child) + hv);
-                } else if ((iter = find(closed.begin(), closed.end(), child)) != closed.end() &&
-                        g(*child) < g(*(*iter))) {
-                    auto &old = *iter;
+            ++stats.expanded;
+            impl::expand(pbn, children);
+            stats.generated += static_cast<std::int64_t>(children.size());
+            for (auto &child : children) {
+                auto gv = g(child);
+                auto iter = table.find(&child);
+                if (iter == table.end()) {
+                    child.setCost(gv + h(child));
+                    auto node = pool.create(child);
+                    open.push(node);
+                    table.insert(node);
+                } else if (gv < g(*(*iter))) {
+                    // A cheaper path to a known state, reopen it whether it was expanded or not
+                    auto old = *iter;
                     old->setParent(pbn);
-                    old->setCost(g(*child) + hv);
-                    open.push_front(old);
-                    closed.remove(old);
+                    old->setDepth(child.getDepth());
+                    old->setCost(gv + h(child));
+                    open.push(old);
                 } else {
-                    child->setCost(g(*child) + hv);
-                    open.push_front(child);
+                    ++stats.duplicates;
                 }
             }
+            stats.peak_open = std::max(stats.peak_open, open.size());
+        }
+
+        return finish(Result::FAILED, nullptr);
+    }
+
+    template<typename E, typename G, typename H>
+    Result aStar(const E &start, const E &target, G g, H h, const Limits &limits = Limits()) {
+        Workspace<E> workspace;
+        return aStar(start, target, std::move(g), std::move(h), workspace, limits);
+    }
+
+    namespace impl {
+        // Weights are fixed point with WEIGHT_ONE steps per unit, so costs stay integers. Rounding
+        // down keeps the bound the caller asked for.
+        constexpr int WEIGHT_ONE = 256;
+
+        inline int fixedWeight(double weight) {
+            return std::max(WEIGHT_ONE, static_cast<int>(weight * WEIGHT_ONE));
+        }
+    }
+
+    // A* ordered by g + weight * h. With an admissible h the solution is at most weight times as
+    // long as the shortest, and is usually found after far fewer expansions.
+    template<typename E, typename G, typename H>
+    Result weightedAStar(const E &start, const E &target, G g, H h, double weight, Workspace<E> &workspace,
+                         const Limits &limits = Limits()) {
+        auto w = impl::fixedWeight(weight);
+        // Progress is reported in moves, not in fixed point
+        auto scaled = limits;
+        if (limits.progress) {
+            scaled.progress = [&limits](const Progress &progress) {
+                limits.progress({progress.bound / impl::WEIGHT_ONE, progress.expanded});
+            };
         }
+        return aStar(start, target,
+                     [g](const Node<E> &node) {
+                         return impl::WEIGHT_ONE * g(node);
+                     },
+                     [h, w](const Node<E> &node) {
+                         return w * h(node);
+                     },
+                     workspace, scaled);
+    }
+
+    template<typename E, typename G, typename H>
+    Result weightedAStar(const E &start, const E &target, G g, H h, double weight, const Limits &limits = Limits()) {
+        Workspace<E> workspace;
+        return weightedAStar(start, target, std::move(g), std::move(h), weight, workspace, limits);
+    }
 
-        return {Result::FAILED, steps};
+    template<typename E, typename H>
+    Result idaStar(const E &start, const E &target, H h, const Limits &limits = Limits()) {
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        impl::Stopwatch stopwatch;
+        Statistics stats;
+        auto current = start;
+        std::int64_t steps = 0;
+        auto bound = h(current);
+        auto stopped = false;
+        while (true) {
+            auto next_bound = std::numeric_limits<int>::max();
+            Path path;
+            auto found = impl::idaSearch(current, target, h, 0, bound, E::Move::IDLE, steps, next_bound, stats,
+                                         path, limits, stopped);
+            stopwatch.lap(stats, "iteration");
+            if (found) {
+                return {Result::SUCCESS, steps, std::move(stats), std::move(path)};
+            }
+            if (stopped || next_bound == std::numeric_limits<int>::max()) {
+                return {Result::FAILED, steps, std::move(stats)};
+            }
+            bound = next_bound;
+        }
     }
 }
 #endif //NPUZZLE_GRAPHSEARCH_H
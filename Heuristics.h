@@ -0,0 +1,240 @@
+#ifndef NPUZZLE_HEURISTICS_H
+#define NPUZZLE_HEURISTICS_H
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "Board.h"
+
+namespace board {
+    namespace impl {
+        constexpr int power(int base, int exponent) {
+            int result = 1;
+            for (int i = 0; i < exponent; ++i)
+                result *= base;
+            return result;
+        }
+    }
+
+    // Manhattan distance plus linear conflicts. Pieces in their target row must pass each other to
+    // reach their columns when they are out of order; all but the longest increasing run of them
+    // have to leave the row and come back, two moves apiece that the Manhattan distance does not
+    // count, and likewise for columns. Rows and columns share one table, indexed by the target
+    // position along the line of each piece that belongs there, N + 1 values per cell.
+    template<std::uint8_t N>
+    class LinearConflict {
+    public:
+        using Piece = typename Board<N>::Piece;
+
+        static constexpr int SIZE = Board<N>::SIZE;
+
+        static constexpr int RADIX = N + 1;
+
+        static constexpr int LINES = impl::power(RADIX, N);
+
+        explicit LinearConflict(const Board<N> &target);
+
+        int operator()(const Board<N> &board) const noexcept {
+            int distance = 0;
+            std::array<int, N> rows{};
+            std::array<int, N> columns{};
+            for (int i = 0; i < SIZE; ++i) {
+                auto piece = board[i];
+                distance += goal_.distance(piece, i);
+                rows[i / N] += row_code_[piece][i];
+                columns[i % N] += column_code_[piece][i];
+            }
+            for (int line = 0; line < N; ++line)
+                distance += table_[rows[line]] + table_[columns[line]];
+            return distance;
+        }
+
+    private:
+        Goal<N> goal_;
+        // Digit of every piece at every cell in the index of its row, and of its column
+        std::array<std::array<std::uint32_t, SIZE>, SIZE> row_code_{};
+        std::array<std::array<std::uint32_t, SIZE>, SIZE> column_code_{};
+        std::vector<std::uint8_t> table_;
+    };
+
+    template<std::uint8_t N>
+    LinearConflict<N>::LinearConflict(const Board<N> &target) : goal_(target), table_(LINES) {
+        for (int piece = 1; piece < SIZE; ++piece) {
+            auto j = goal_.index(static_cast<Piece>(piece));
+            for (int i = 0; i < SIZE; ++i) {
+                if (i / N == j / N)
+                    row_code_[piece][i] = static_cast<std::uint32_t>((j % N + 1) * impl::power(RADIX, i % N));
+                if (i % N == j % N)
+                    column_code_[piece][i] = static_cast<std::uint32_t>((j / N + 1) * impl::power(RADIX, i / N));
+            }
+        }
+
+        for (int index = 0; index < LINES; ++index) {
+            // Longest increasing run of the target positions along the line
+            std::array<int, N> longest{};
+            int pieces = 0;
+            int best = 0;
+            for (int k = 0, rest = index; k < N; ++k, rest /= RADIX) {
+                auto position = rest % RADIX;
+                if (position == 0)
+                    continue;
+                longest[k] = 1;
+                for (int l = 0, before = index; l < k; ++l, before /= RADIX)
+                    if (before % RADIX != 0 && before % RADIX < position)
+                        longest[k] = std::max(longest[k], longest[l] + 1);
+                best = std::max(best, longest[k]);
+                ++pieces;
+            }
+            table_[index] = static_cast<std::uint8_t>(2 * (pieces - best));
+        }
+    }
+
+    template<std::uint8_t N>
+    constexpr int LinearConflict<N>::LINES;
+
+    // Takahashi's walking distance. Projected onto rows a board is, for every row, how many of its
+    // pieces belong in each row; a vertical move carries one piece to the row of the blank. The
+    // moves between these projections from the target's are counted once, breadth first, and the
+    // same for columns with horizontal moves. Both are needed and no move does both, so their sum
+    // is admissible; it is at least the Manhattan distance, as pieces walking to their row or column
+    // get in each other's way. A projection packs its N * N counts 3 bits apiece.
+    template<std::uint8_t N>
+    class WalkingDistance {
+        static_assert(N <= 4, "the 5x5 tables take millions of projections");
+
+    public:
+        using Piece = typename Board<N>::Piece;
+
+        static constexpr int SIZE = Board<N>::SIZE;
+
+        explicit WalkingDistance(const Board<N> &target);
+
+        int operator()(const Board<N> &board) const noexcept {
+            std::uint64_t rows = 0;
+            std::uint64_t columns = 0;
+            for (int i = 0; i < SIZE; ++i) {
+                rows += row_key_[board[i]][i];
+                columns += column_key_[board[i]][i];
+            }
+            return rows_.distance(rows) + columns_.distance(columns);
+        }
+
+        // Projections of one kind reachable from the target's
+        std::size_t size() const noexcept {
+            return std::max(rows_.size(), columns_.size());
+        }
+
+    private:
+        // Distances of the projections in an open addressed table at most half full, probed linearly
+        class Table {
+        public:
+            explicit Table(int blank_line);
+
+            int distance(std::uint64_t key) const noexcept {
+                auto slot = hash(key);
+                while (keys_[slot] != key)
+                    slot = (slot + 1) & mask_;
+                return distances_[slot];
+            }
+
+            std::size_t size() const noexcept {
+                return size_;
+            }
+
+        private:
+            static int count(std::uint64_t key, int line, int home) noexcept {
+                return static_cast<int>(key >> 3 * (line * N + home) & 7);
+            }
+
+            static std::uint64_t unit(int line, int home) noexcept {
+                return std::uint64_t{1} << 3 * (line * N + home);
+            }
+
+            std::size_t hash(std::uint64_t key) const noexcept {
+                return static_cast<std::size_t>(key * 0x9E3779B97F4A7C15ULL >> shift_);
+            }
+
+            // Every projection holds pieces, the empty key marks free slots
+            std::vector<std::uint64_t> keys_;
+            std::vector<std::uint8_t> distances_;
+            std::size_t size_ = 0;
+            std::size_t mask_ = 0;
+            int shift_ = 64;
+        };
+
+        // The count of every piece at every cell in the projection, 0 for the blank
+        std::array<std::array<std::uint64_t, SIZE>, SIZE> row_key_{};
+        std::array<std::array<std::uint64_t, SIZE>, SIZE> column_key_{};
+        Table rows_;
+        Table columns_;
+    };
+
+    template<std::uint8_t N>
+    WalkingDistance<N>::WalkingDistance(const Board<N> &target)
+            : rows_(target.blankIndex() / N), columns_(target.blankIndex() % N) {
+        std::array<int, SIZE> index;
+        for (int i = 0; i < SIZE; ++i)
+            index[target[i]] = i;
+        for (int piece = 1; piece < SIZE; ++piece)
+            for (int i = 0; i < SIZE; ++i) {
+                row_key_[piece][i] = std::uint64_t{1} << 3 * (i / N * N + index[piece] / N);
+                column_key_[piece][i] = std::uint64_t{1} << 3 * (i % N * N + index[piece] % N);
+            }
+    }
+
+    template<std::uint8_t N>
+    WalkingDistance<N>::Table::Table(int blank_line) {
+        // Every line holds its own N pieces but the one the blank belongs in
+        std::uint64_t start = 0;
+        for (int line = 0; line < N; ++line)
+            start += unit(line, line) * (line == blank_line ? N - 1 : N);
+
+        std::unordered_map<std::uint64_t, std::uint8_t> distances{{start, 0}};
+        std::deque<std::uint64_t> open{start};
+        while (!open.empty()) {
+            auto key = open.front();
+            open.pop_front();
+            auto d = distances[key];
+            int blank = 0;
+            for (int line = 0; line < N; ++line) {
+                int pieces = 0;
+                for (int home = 0; home < N; ++home)
+                    pieces += count(key, line, home);
+                if (pieces < N)
+                    blank = line;
+            }
+            for (int line = blank - 1; line <= blank + 1; line += 2) {
+                if (line < 0 || line >= N)
+                    continue;
+                for (int home = 0; home < N; ++home) {
+                    if (count(key, line, home) == 0)
+                        continue;
+                    auto next = key - unit(line, home) + unit(blank, home);
+                    if (distances.emplace(next, static_cast<std::uint8_t>(d + 1)).second)
+                        open.push_back(next);
+                }
+            }
+        }
+
+        size_ = distances.size();
+        std::size_t slots = 1;
+        for (; slots < 2 * size_; slots *= 2)
+            --shift_;
+        mask_ = slots - 1;
+        keys_.assign(slots, 0);
+        distances_.assign(slots, 0);
+        for (const auto &entry : distances) {
+            auto slot = hash(entry.first);
+            while (keys_[slot] != 0)
+                slot = (slot + 1) & mask_;
+            keys_[slot] = entry.first;
+            distances_[slot] = entry.second;
+        }
+    }
+}
+
+#endif //NPUZZLE_HEURISTICS_H
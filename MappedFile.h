@@ -0,0 +1,125 @@
+#ifndef NPUZZLE_MAPPEDFILE_H
+#define NPUZZLE_MAPPEDFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace io {
+    // Read-only mapping of a whole file, the pages are shared by every process mapping it
+    class MappedFile {
+    public:
+        MappedFile() = default;
+
+        explicit MappedFile(const std::string &path);
+
+        MappedFile(const MappedFile &rhs) = delete;
+
+        MappedFile(MappedFile &&rhs) noexcept {
+            *this = std::move(rhs);
+        }
+
+        MappedFile &operator=(const MappedFile &rhs) = delete;
+
+        MappedFile &operator=(MappedFile &&rhs) noexcept {
+            if (this != &rhs) {
+                close();
+                data_ = rhs.data_;
+                size_ = rhs.size_;
+                rhs.data_ = nullptr;
+                rhs.size_ = 0;
+            }
+            return *this;
+        }
+
+        ~MappedFile() {
+            close();
+        }
+
+        bool isOpen() const noexcept {
+            return data_ != nullptr;
+        }
+
+        const std::uint8_t *data() const noexcept {
+            return data_;
+        }
+
+        std::size_t size() const noexcept {
+            return size_;
+        }
+
+    private:
+        void close() noexcept;
+
+        const std::uint8_t *data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+#ifdef _WIN32
+    inline MappedFile::MappedFile(const std::string &path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (view) {
+                    data_ = static_cast<const std::uint8_t *>(view);
+                    size_ = static_cast<std::size_t>(size.QuadPart);
+                }
+                // The view keeps the mapping alive
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+
+    inline void MappedFile::close() noexcept {
+        if (data_)
+            UnmapViewOfFile(data_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+#else
+    inline MappedFile::MappedFile(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            auto view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (view != MAP_FAILED) {
+                data_ = static_cast<const std::uint8_t *>(view);
+                size_ = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+    }
+
+    inline void MappedFile::close() noexcept {
+        if (data_)
+            ::munmap(const_cast<std::uint8_t *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+#endif
+}
+
+#endif //NPUZZLE_MAPPEDFILE_H
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <type_traits>
 #include <vector>
 
 namespace search {
@@ -11,55 +12,39 @@ namespace search {
     class Node;
 
     template<typename E>
-    using NodePtr = std::shared_ptr<Node<E>>;
+    using NodePtr = Node<E> *;
 
     template<typename E>
     class Node {
     public:
-        explicit Node(const E &elem) : elem_(std::make_unique<E>(elem)){}
+        explicit Node(const E &elem) : elem_(elem) {}
 
-        explicit Node(std::unique_ptr<E> &&elem) : elem_(std::move(elem)) {}
+        Node(const E &elem, Node *parent, int depth) : elem_(elem), parent_(parent), depth_(depth) {}
 
-        Node(const Node &rhs) : elem_(std::make_unique<E>(rhs.elem)), parent_(rhs.parent_) {}
+        Node(const Node &rhs) = default;
 
-        Node(Node &&rhs) noexcept: elem_(std::move(rhs.elem)), parent_(rhs.parent_) {}
+        Node(Node &&rhs) noexcept = default;
 
-        Node &operator=(const Node &rhs) {
-            if (this != &rhs) {
-                *elem_ = *rhs.elem_;
-                parent_ = rhs.parent_;
-            }
-            return *this;
-        }
+        Node &operator=(const Node &rhs) = default;
 
-        Node &operator=(Node &&rhs) noexcept {
-            if (this != &rhs) {
-                elem_ = std::move(rhs.elem_);
-                parent_ = rhs.parent_;
-            }
-            return *this;
-        };
+        Node &operator=(Node &&rhs) noexcept = default;
 
         ~Node() = default;
 
         bool operator==(const Node &rhs) const noexcept {
-            return *elem_ == *rhs.elem_;
+            return elem_ == rhs.elem_;
         }
 
         bool operator!=(const Node &rhs) const noexcept {
-            return *elem_ != *rhs.elem_;
+            return elem_ != rhs.elem_;
         }
 
-        void setParent(const NodePtr<E> &parent) {
+        void setParent(Node *parent) {
             parent_ = parent;
         }
 
-        NodePtr<E> getParent() {
-            auto parent = parent_.lock();
-            if (!parent) {
-                parent_.reset();
-            }
-            return parent;
+        Node *getParent() const {
+            return parent_;
         }
 
         void setDepth(int depth) {
@@ -78,30 +63,78 @@ namespace search {
             return cost_;
         }
 
-        E &get() const {
-            return *elem_;
+        E &get() {
+            return elem_;
         }
 
-        std::vector<NodePtr<E>> expand();
+        const E &get() const {
+            return elem_;
+        }
 
     private:
-        std::unique_ptr<E> elem_;
-        std::weak_ptr<Node> parent_{};
+        E elem_;
+        Node *parent_ = nullptr;
         int depth_ = 0;
         int cost_ = 0;
     };
 
+    // Bump allocator owning every node of a search, parents are plain pointers into it.
+    // clear() frees the whole search at once and keeps the chunks for the next one.
     template<typename E>
-    std::vector<NodePtr<E>> Node<E>::expand() {
-        auto elements = this->elem_->expand();
-        std::vector<NodePtr<E>> children;
-        children.reserve(4);
-        for (auto &elem : elements) {
-            auto node = std::make_shared<Node>(std::move(elem));
-            children.push_back(std::move(node));
-        }
-        return children;
-    }
+    class NodePool {
+    public:
+        static constexpr std::size_t CHUNK = 4096;
+
+        NodePool() = default;
+
+        NodePool(const NodePool &rhs) = delete;
+
+        NodePool &operator=(const NodePool &rhs) = delete;
+
+        ~NodePool() {
+            clear();
+        }
+
+        template<typename... Args>
+        NodePtr<E> create(Args &&... args) {
+            if (size_ == chunks_.size() * CHUNK)
+                chunks_.emplace_back(new Storage[CHUNK]);
+            auto node = new(&chunks_[size_ / CHUNK][size_ % CHUNK]) Node<E>(std::forward<Args>(args)...);
+            ++size_;
+            return node;
+        }
+
+        void clear() noexcept {
+            destroy(std::is_trivially_destructible<E>{});
+            size_ = 0;
+        }
+
+        std::size_t size() const noexcept {
+            return size_;
+        }
+
+        std::size_t capacity() const noexcept {
+            return chunks_.size() * CHUNK;
+        }
+
+        // Bytes held by the chunks, allocated or not
+        std::size_t memory() const noexcept {
+            return capacity() * sizeof(Storage);
+        }
+
+    private:
+        using Storage = typename std::aligned_storage<sizeof(Node<E>), alignof(Node<E>)>::type;
+
+        void destroy(std::true_type) noexcept {}
+
+        void destroy(std::false_type) noexcept {
+            for (std::size_t i = 0; i < size_; ++i)
+                reinterpret_cast<Node<E> *>(&chunks_[i / CHUNK][i % CHUNK])->~Node();
+        }
+
+        std::vector<std::unique_ptr<Storage[]>> chunks_;
+        std::size_t size_ = 0;
+    };
 
     template<typename InputIt, typename E>
     inline InputIt find(InputIt first, InputIt last, const NodePtr<E> &target) {
@@ -109,5 +142,19 @@ namespace search {
             return *node == *target;
         });
     }
+
+    template<typename E>
+    struct NodeHash {
+        std::size_t operator()(const Node<E> *node) const noexcept {
+            return std::hash<E>{}(node->get());
+        }
+    };
+
+    template<typename E>
+    struct NodeEqual {
+        bool operator()(const Node<E> *lhs, const Node<E> *rhs) const noexcept {
+            return *lhs == *rhs;
+        }
+    };
 }
 #endif //NPUZZLE_NODE_H
@@ -0,0 +1,580 @@
+#ifndef NPUZZLE_PARALLELSEARCH_H
+#define NPUZZLE_PARALLELSEARCH_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "GraphSearch.h"
+
+namespace search {
+    namespace impl {
+        // Nodes posted to a worker by the others, exchanged in batches under a lock
+        template<typename E>
+        class Mailbox {
+        public:
+            void post(std::vector<Node<E>> &batch) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto &node : batch)
+                    nodes_.push_back(std::move(node));
+                batch.clear();
+            }
+
+            void collect(std::vector<Node<E>> &batch) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                nodes_.swap(batch);
+            }
+
+            bool empty() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return nodes_.empty();
+            }
+
+        private:
+            mutable std::mutex mutex_;
+            std::vector<Node<E>> nodes_;
+        };
+
+        // Hash distributed A* (HDA*): every state belongs to the worker picked by its hash, which
+        // alone keeps it in its open list and its table, so duplicate detection needs no locking.
+        // Nodes travel by value and are only copied into the pool of their owner; parents may
+        // point into the pool of another worker, so every pool lives as long as the search.
+        template<typename E, typename G, typename H>
+        class ParallelAStar {
+        public:
+            ParallelAStar(const E &target, G g, H h, unsigned threads)
+                    : target_(target), g_(std::move(g)), h_(std::move(h)), threads_(threads),
+                      mailboxes_(threads), work_(threads) {
+                for (unsigned id = 0; id < threads_; ++id)
+                    pools_.emplace_back(new NodePool<E>());
+            }
+
+            Result run(const E &start) {
+                Stopwatch stopwatch;
+                Node<E> ps(start);
+                ps.setCost(g_(ps) + h_(ps));
+
+                std::vector<std::thread> workers;
+                for (unsigned id = 0; id < threads_; ++id)
+                    workers.emplace_back([this, id, &ps] {
+                        work(id, owner(ps) == id ? &ps : nullptr);
+                    });
+                for (auto &worker : workers)
+                    worker.join();
+                stopwatch.lap(stats_, "search");
+
+                if (incumbent_.load() == std::numeric_limits<int>::max())
+                    return {Result::FAILED, steps_.load(), std::move(stats_)};
+                // Parents only change while workers run, the chain is stable once they joined
+                return {Result::SUCCESS, steps_.load(), std::move(stats_), tracePath(*goal_)};
+            }
+
+        private:
+            // Flush outgoing batches once they hold this many nodes, or every FLUSH_INTERVAL expansions
+            static constexpr std::size_t BATCH = 64;
+            static constexpr std::int64_t FLUSH_INTERVAL = 256;
+
+            unsigned owner(const Node<E> &node) const {
+                return static_cast<unsigned>(std::hash<E>{}(node.get()) % threads_);
+            }
+
+            void work(unsigned id, Node<E> *start);
+
+            // Adds the counters of a finished worker, peaks are summed as the workers run side by side
+            void merge(const Statistics &stats);
+
+            const E target_;
+            const G g_;
+            const H h_;
+            const unsigned threads_;
+            std::vector<Mailbox<E>> mailboxes_;
+            std::vector<std::unique_ptr<NodePool<E>>> pools_;
+            std::atomic<int> incumbent_{std::numeric_limits<int>::max()};
+            std::atomic<std::int64_t> steps_{0};
+            std::mutex stats_mutex_;
+            Statistics stats_;
+            // Goal node of the incumbent, guarded by stats_mutex_
+            NodePtr<E> goal_ = nullptr;
+            int goal_cost_ = std::numeric_limits<int>::max();
+            // Busy workers plus nodes posted but not yet received, the search is over once it drops to 0
+            std::atomic<std::int64_t> work_;
+        };
+
+        template<typename E, typename G, typename H>
+        void ParallelAStar<E, G, H>::work(unsigned id, Node<E> *start) {
+            auto &pool = *pools_[id];
+            OpenList<E> open;
+            NodeTable<E> table;
+            std::vector<std::vector<Node<E>>> outgoing(threads_);
+            std::vector<Node<E>> incoming;
+            std::vector<Node<E>> children;
+            std::int64_t steps = 0;
+            Statistics stats;
+            bool busy = true;
+
+            auto receive = [&](Node<E> &child) {
+                auto iter = table.find(&child);
+                if (iter == table.end()) {
+                    auto node = pool.create(child);
+                    open.push(node);
+                    table.insert(node);
+                } else if (g_(child) < g_(*(*iter))) {
+                    auto old = *iter;
+                    old->setParent(child.getParent());
+                    old->setDepth(child.getDepth());
+                    old->setCost(child.getCost());
+                    open.push(old);
+                } else {
+                    ++stats.duplicates;
+                }
+            };
+
+            auto flush = [&](unsigned to) {
+                if (outgoing[to].empty())
+                    return;
+                work_.fetch_add(static_cast<std::int64_t>(outgoing[to].size()));
+                mailboxes_[to].post(outgoing[to]);
+            };
+
+            if (start)
+                receive(*start);
+
+            while (true) {
+                if (!mailboxes_[id].empty()) {
+                    if (!busy) {
+                        busy = true;
+                        work_.fetch_add(1);
+                    }
+                    mailboxes_[id].collect(incoming);
+                    for (auto &node : incoming)
+                        receive(node);
+                    work_.fetch_sub(static_cast<std::int64_t>(incoming.size()));
+                    incoming.clear();
+                }
+
+                NodePtr<E> pbn = nullptr;
+                while (!open.empty() && !pbn) {
+                    pbn = open.pop();
+                    if (pbn && pbn->getCost() >= incumbent_.load(std::memory_order_relaxed))
+                        pbn = nullptr;
+                }
+
+                if (!pbn) {
+                    // Nothing below the incumbent is left here, whatever remains in open never will be
+                    for (unsigned to = 0; to < threads_; ++to)
+                        flush(to);
+                    open.clear();
+                    if (busy) {
+                        busy = false;
+                        work_.fetch_sub(1);
+                    }
+                    if (work_.load() == 0)
+                        break;
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                ++steps;
+                if (pbn->get() == target_) {
+                    auto cost = pbn->getCost();
+                    auto best = incumbent_.load();
+                    while (cost < best && !incumbent_.compare_exchange_weak(best, cost))
+                        continue;
+                    if (cost < best) {
+                        std::lock_guard<std::mutex> lock(stats_mutex_);
+                        if (cost < goal_cost_) {
+                            goal_ = pbn;
+                            goal_cost_ = cost;
+                        }
+                    }
+                    continue;
+                }
+
+                ++stats.expanded;
+                expand(pbn, children);
+                stats.generated += static_cast<std::int64_t>(children.size());
+                for (auto &child : children) {
+                    child.setCost(g_(child) + h_(child));
+                    if (child.getCost() >= incumbent_.load(std::memory_order_relaxed))
+                        continue;
+                    auto to = owner(child);
+                    if (to == id) {
+                        receive(child);
+                    } else {
+                        outgoing[to].push_back(std::move(child));
+                        if (outgoing[to].size() >= BATCH)
+                            flush(to);
+                    }
+                }
+
+                stats.peak_open = std::max(stats.peak_open, open.size());
+                if (steps % FLUSH_INTERVAL == 0)
+                    for (unsigned to = 0; to < threads_; ++to)
+                        flush(to);
+            }
+
+            stats.peak_closed = table.size();
+            stats.peak_memory = pool.memory() + open.memory() + impl::memory<E>(table) +
+                                children.capacity() * sizeof(Node<E>);
+            steps_.fetch_add(steps);
+            merge(stats);
+        }
+
+        template<typename E, typename G, typename H>
+        void ParallelAStar<E, G, H>::merge(const Statistics &stats) {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.expanded += stats.expanded;
+            stats_.generated += stats.generated;
+            stats_.duplicates += stats.duplicates;
+            stats_.peak_open += stats.peak_open;
+            stats_.peak_closed += stats.peak_closed;
+            stats_.peak_memory += stats.peak_memory;
+        }
+
+        // Fixed-size transposition table shared by the workers without locks. It is lossy: a store
+        // overwrites whatever shares its slot. Each slot keeps key ^ data beside data, so a slot
+        // torn by two writers at once no longer matches either key and reads as empty. Data is
+        // the depth a state was reached at and the iteration, entries of earlier ones are stale.
+        class TranspositionTable {
+        public:
+            explicit TranspositionTable(std::size_t bytes) {
+                std::size_t slots = 1;
+                for (; slots * 2 * sizeof(Slot) <= bytes; slots *= 2)
+                    --shift_;
+                slots_.reset(new Slot[slots]);
+                size_ = slots;
+            }
+
+            // Depth key was reached at in this iteration, -1 if that is not recorded
+            int depth(std::uint64_t key, std::uint32_t iteration) const noexcept {
+                const auto &slot = slots_[index(key)];
+                auto data = slot.data.load(std::memory_order_relaxed);
+                if ((slot.check.load(std::memory_order_relaxed) ^ data) != key ||
+                    data >> 32 != iteration)
+                    return -1;
+                return static_cast<int>(data & 0xFFFF);
+            }
+
+            void store(std::uint64_t key, int depth, std::uint32_t iteration) noexcept {
+                auto &slot = slots_[index(key)];
+                auto data = static_cast<std::uint64_t>(iteration) << 32 | static_cast<std::uint64_t>(depth);
+                slot.check.store(key ^ data, std::memory_order_relaxed);
+                slot.data.store(data, std::memory_order_relaxed);
+            }
+
+            std::size_t memory() const noexcept {
+                return size_ * sizeof(Slot);
+            }
+
+        private:
+            struct Slot {
+                std::atomic<std::uint64_t> check{0};
+                std::atomic<std::uint64_t> data{0};
+            };
+
+            std::size_t index(std::uint64_t key) const noexcept {
+                return shift_ == 64 ? 0 : static_cast<std::size_t>(key * 0x9E3779B97F4A7C15ULL >> shift_);
+            }
+
+            std::unique_ptr<Slot[]> slots_;
+            std::size_t size_ = 0;
+            int shift_ = 64;
+        };
+
+        // Key of a packed state for the transposition table, exact when it packs into one word
+        inline std::uint64_t fingerprint(std::uint64_t packed) noexcept {
+            return packed;
+        }
+
+        template<std::size_t K>
+        std::uint64_t fingerprint(const std::array<std::uint64_t, K> &packed) noexcept {
+            auto key = packed[0];
+            for (std::size_t i = 1; i < K; ++i)
+                key = (key ^ key >> 29) * 0xBF58476D1CE4E5B9ULL ^ packed[i];
+            return key;
+        }
+
+        // Tasks of one worker: it takes the last one, thieves the first, the oldest and usually
+        // the largest subtree. Tasks are whole subtrees, so one lock per deque hardly contends.
+        template<typename T>
+        class StealingDeque {
+        public:
+            void push(T item) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                items_.push_back(std::move(item));
+            }
+
+            bool pop(T &item) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (items_.empty())
+                    return false;
+                item = std::move(items_.back());
+                items_.pop_back();
+                return true;
+            }
+
+            bool steal(T &item) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (items_.empty())
+                    return false;
+                item = std::move(items_.front());
+                items_.pop_front();
+                return true;
+            }
+
+        private:
+            std::mutex mutex_;
+            std::deque<T> items_;
+        };
+
+        // Parallel IDA*: every iteration expands the top of the tree level by level until there
+        // are TASKS_PER_THREAD subtrees per worker, deals them out to the workers' deques and
+        // searches them depth first against the shared bound, idle workers stealing from the
+        // others. States reached again no shallower than before, by any worker, are pruned
+        // through the transposition table. A solution lies at the bound of the first iteration
+        // that finds one, so its length is optimal however the work was spread.
+        template<typename E, typename H>
+        class ParallelIdaStar {
+        public:
+            using Move = typename E::Move;
+
+            ParallelIdaStar(const E &target, H h, unsigned threads, std::size_t table_bytes)
+                    : target_(target), h_(std::move(h)), threads_(threads), table_(table_bytes),
+                      deques_(threads) {}
+
+            Result run(const E &start);
+
+        private:
+            // More tasks balance the load better, but the table only prunes below them
+            static constexpr std::size_t TASKS_PER_THREAD = 64;
+
+            // Subtrees this close to the bound cost less to search than to look up
+            static constexpr int TABLE_MIN_REMAINING = 4;
+
+            struct Task {
+                E state;
+                int g;
+                Move last;
+                std::vector<Move> moves;
+            };
+
+            struct Worker {
+                std::vector<Move> moves;
+                std::int64_t steps = 0;
+                int next_bound = std::numeric_limits<int>::max();
+                Statistics stats;
+            };
+
+            // Expands the top levels into tasks_, false if the target turned up among them
+            bool split(const E &start, int bound, Worker &worker);
+
+            void work(unsigned id, int bound, Worker &worker);
+
+            bool search(E &current, int g, int bound, Move last, Worker &worker);
+
+            void finish(const std::vector<Move> &moves, std::size_t length);
+
+            const E target_;
+            const H h_;
+            const unsigned threads_;
+            TranspositionTable table_;
+            // Tasks of the current iteration, dealt out by index
+            std::vector<Task> tasks_;
+            std::vector<StealingDeque<std::size_t>> deques_;
+            std::uint32_t iteration_ = 0;
+            std::atomic<bool> found_{false};
+            std::mutex path_mutex_;
+            Path path_;
+        };
+
+        template<typename E, typename H>
+        Result ParallelIdaStar<E, H>::run(const E &start) {
+            Stopwatch stopwatch;
+            Statistics stats;
+            std::int64_t steps = 0;
+            auto bound = h_(start);
+            while (true) {
+                ++iteration_;
+                std::vector<Worker> workers(threads_);
+                if (split(start, bound, workers[0])) {
+                    for (std::size_t i = 0; i < tasks_.size(); ++i)
+                        deques_[i % threads_].push(i);
+                    std::vector<std::thread> threads;
+                    for (unsigned id = 0; id < threads_; ++id)
+                        threads.emplace_back([this, id, bound, &workers] {
+                            work(id, bound, workers[id]);
+                        });
+                    for (auto &thread : threads)
+                        thread.join();
+                }
+
+                auto next_bound = std::numeric_limits<int>::max();
+                for (const auto &worker : workers) {
+                    steps += worker.steps;
+                    next_bound = std::min(next_bound, worker.next_bound);
+                    stats.expanded += worker.stats.expanded;
+                    stats.generated += worker.stats.generated;
+                    stats.duplicates += worker.stats.duplicates;
+                    stats.peak_open = std::max(stats.peak_open, worker.stats.peak_open);
+                }
+                stats.peak_memory = table_.memory();
+                stopwatch.lap(stats, "iteration");
+                if (found_.load())
+                    return {Result::SUCCESS, steps, std::move(stats), std::move(path_)};
+                if (next_bound == std::numeric_limits<int>::max())
+                    return {Result::FAILED, steps, std::move(stats)};
+                bound = next_bound;
+            }
+        }
+
+        template<typename E, typename H>
+        bool ParallelIdaStar<E, H>::split(const E &start, int bound, Worker &worker) {
+            std::vector<Task> level{{start, 0, Move::IDLE, {}}};
+            std::vector<Task> next;
+            while (level.size() < threads_ * TASKS_PER_THREAD) {
+                for (auto &task : level) {
+                    ++worker.steps;
+                    auto f = task.g + h_(task.state);
+                    if (f > bound) {
+                        worker.next_bound = std::min(worker.next_bound, f);
+                        continue;
+                    }
+                    if (task.state == target_) {
+                        finish(task.moves, task.moves.size());
+                        return false;
+                    }
+                    ++worker.stats.expanded;
+                    for (auto move = Move(); move != Move::IDLE; ++move) {
+                        auto child = task.state;
+                        if (move == inverse(task.last) || !child.apply(move))
+                            continue;
+                        ++worker.stats.generated;
+                        next.push_back({child, task.g + 1, move, task.moves});
+                        next.back().moves.push_back(move);
+                    }
+                }
+                level.swap(next);
+                next.clear();
+                if (level.empty())
+                    break;
+            }
+            tasks_.swap(level);
+            return true;
+        }
+
+        template<typename E, typename H>
+        void ParallelIdaStar<E, H>::work(unsigned id, int bound, Worker &worker) {
+            worker.moves.resize(static_cast<std::size_t>(bound) + 1);
+            std::size_t index;
+            while (!found_.load(std::memory_order_relaxed)) {
+                auto taken = deques_[id].pop(index);
+                for (unsigned i = 1; !taken && i < threads_; ++i)
+                    taken = deques_[(id + i) % threads_].steal(index);
+                if (!taken)
+                    break;
+                auto &task = tasks_[index];
+                std::copy(task.moves.begin(), task.moves.end(), worker.moves.begin());
+                if (search(task.state, task.g, bound, task.last, worker))
+                    break;
+            }
+            // Someone found the target, what is left of this iteration is not needed
+            while (deques_[id].pop(index))
+                continue;
+        }
+
+        template<typename E, typename H>
+        bool ParallelIdaStar<E, H>::search(E &current, int g, int bound, Move last, Worker &worker) {
+            if (found_.load(std::memory_order_relaxed))
+                return false;
+            ++worker.steps;
+            auto f = g + h_(current);
+            if (f > bound) {
+                worker.next_bound = std::min(worker.next_bound, f);
+                return false;
+            }
+            if (current == target_) {
+                finish(worker.moves, static_cast<std::size_t>(g));
+                return true;
+            }
+            if (bound - g >= TABLE_MIN_REMAINING) {
+                // Reached before no deeper, the subtree is searched with at least as many moves left
+                auto key = fingerprint(current.pack());
+                auto seen = table_.depth(key, iteration_);
+                if (seen >= 0 && seen <= g) {
+                    ++worker.stats.duplicates;
+                    return false;
+                }
+                table_.store(key, g, iteration_);
+            }
+
+            ++worker.stats.expanded;
+            worker.stats.peak_open = std::max(worker.stats.peak_open, static_cast<std::size_t>(g + 1));
+            for (auto move = Move(); move != Move::IDLE; ++move) {
+                if (move == inverse(last) || !current.apply(move))
+                    continue;
+                ++worker.stats.generated;
+                worker.moves[static_cast<std::size_t>(g)] = move;
+                auto found = search(current, g + 1, bound, move, worker);
+                current.apply(inverse(move));
+                if (found)
+                    return true;
+            }
+            return false;
+        }
+
+        template<typename E, typename H>
+        void ParallelIdaStar<E, H>::finish(const std::vector<Move> &moves, std::size_t length) {
+            std::lock_guard<std::mutex> lock(path_mutex_);
+            if (found_.load())
+                return;
+            path_ = Path(length);
+            for (std::size_t i = 0; i < length; ++i)
+                path_.set(i, static_cast<int>(moves[i]));
+            found_.store(true);
+        }
+    }
+
+    template<typename E, typename G, typename H>
+    Result parallelAStar(const E &start, const E &target, G g, H h,
+                         unsigned threads = std::thread::hardware_concurrency()) {
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        impl::ParallelAStar<E, G, H> search(target, std::move(g), std::move(h), threads == 0 ? 1 : threads);
+        return search.run(start);
+    }
+
+    // Bytes of the transposition table parallelIdaStar() shares among its workers by default; a
+    // larger table prunes a little more but misses the cache more often, and is cleared every run
+    constexpr std::size_t PARALLEL_IDA_TABLE = std::size_t(4) << 20;
+
+    // IDA* over threads workers that share the iteration bound and a lossy transposition table of
+    // table_bytes. The solution is optimal, so its length is the same on every run; which of the
+    // optimal solutions is found depends on how the threads interleave. E must also have pack().
+    template<typename E, typename H>
+    Result parallelIdaStar(const E &start, const E &target, H h,
+                           unsigned threads = std::thread::hardware_concurrency(),
+                           std::size_t table_bytes = PARALLEL_IDA_TABLE) {
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!impl::reachable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        impl::ParallelIdaStar<E, H> search(target, std::move(h), threads == 0 ? 1 : threads, table_bytes);
+        return search.run(start);
+    }
+}
+
+#endif //NPUZZLE_PARALLELSEARCH_H
@@ -0,0 +1,294 @@
+#ifndef NPUZZLE_PATTERNDATABASE_H
+#define NPUZZLE_PATTERNDATABASE_H
+
+#include <cstdint>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "MappedFile.h"
+#include "Ranking.h"
+
+namespace board {
+    // Additive disjoint pattern databases: each table holds, for every placement of its pieces,
+    // the number of moves of those pieces needed to reach the target, so the tables can be summed.
+    template<std::uint8_t N>
+    class PatternDatabase {
+        static_assert(N * N <= 64, "positions are ranked in a 64-bit mask");
+
+    public:
+        using Piece = typename Board<N>::Piece;
+        using Pattern = std::vector<Piece>;
+
+        static constexpr int SIZE = Board<N>::SIZE;
+
+        // Positions are packed 6 bits apiece together with the blank while building
+        static constexpr int MAX_PATTERN = 9;
+
+        PatternDatabase(const Board<N> &target, const std::vector<Pattern> &patterns);
+
+        PatternDatabase(const PatternDatabase &rhs) = delete;
+
+        PatternDatabase &operator=(const PatternDatabase &rhs) = delete;
+
+        ~PatternDatabase() = default;
+
+        // Maps a file written by save(), nullptr if it is missing or was built for another target
+        static std::unique_ptr<PatternDatabase> load(const Board<N> &target, const std::string &path);
+
+        bool save(const std::string &path) const;
+
+        // Consecutive pieces from 1 split in groups of the given sizes, e.g. {7, 8} for the 15-puzzle
+        static std::vector<Pattern> split(std::initializer_list<int> sizes);
+
+        // 8 for the 8-puzzle, 6-6-3 for the 15-puzzle, 6-6-6-6 for the 24-puzzle, groups of 5 above
+        static std::vector<Pattern> defaultPatterns();
+
+        const Board<N> &target() const noexcept {
+            return target_;
+        }
+
+        const std::vector<Pattern> &patterns() const noexcept {
+            return patterns_;
+        }
+
+        int operator()(const Board<N> &board) const noexcept;
+
+    private:
+        PatternDatabase(const Board<N> &target, std::vector<Pattern> patterns, io::MappedFile &&file);
+
+        static constexpr std::uint8_t VERSION = 1;
+
+        void build(std::size_t p, std::uint8_t *table) const;
+
+        Board<N> target_;
+        std::vector<Pattern> patterns_;
+        std::vector<const std::uint8_t *> tables_;
+        std::vector<std::uint8_t> storage_;
+        io::MappedFile file_;
+    };
+
+    template<std::uint8_t N>
+    PatternDatabase<N>::PatternDatabase(const Board<N> &target, const std::vector<Pattern> &patterns)
+            : target_(target), patterns_(patterns) {
+        std::size_t total = 0;
+        for (const auto &pattern : patterns_)
+            total += impl::placements(SIZE, static_cast<int>(pattern.size()));
+        storage_.assign(total, 0xFF);
+
+        std::size_t offset = 0;
+        for (std::size_t p = 0; p < patterns_.size(); ++p) {
+            build(p, storage_.data() + offset);
+            tables_.push_back(storage_.data() + offset);
+            offset += impl::placements(SIZE, static_cast<int>(patterns_[p].size()));
+        }
+    }
+
+    template<std::uint8_t N>
+    PatternDatabase<N>::PatternDatabase(const Board<N> &target, std::vector<Pattern> patterns, io::MappedFile &&file)
+            : target_(target), patterns_(std::move(patterns)), file_(std::move(file)) {}
+
+    template<std::uint8_t N>
+    void PatternDatabase<N>::build(std::size_t p, std::uint8_t *table) const {
+        const auto &pattern = patterns_[p];
+        const int k = static_cast<int>(pattern.size());
+        constexpr int BITS = 6;
+        constexpr std::uint64_t MASK = (1U << BITS) - 1;
+
+        // A state is the position of every pattern piece followed by the blank. Moving the blank
+        // onto a piece of another pattern is free, so this is a breadth first search over layers
+        // of pattern moves, each layer closed under the free moves before the next one starts.
+        std::vector<bool> visited(impl::placements(SIZE, k) * SIZE, false);
+        auto encode = [](const int *positions, int count) {
+            std::uint64_t state = 0;
+            for (int i = count - 1; i >= 0; --i)
+                state = (state << BITS) | static_cast<std::uint64_t>(positions[i]);
+            return state;
+        };
+
+        int positions[MAX_PATTERN + 1];
+        for (int i = 0; i < SIZE; ++i) {
+            for (int j = 0; j < k; ++j)
+                if (target_[i] == pattern[j])
+                    positions[j] = i;
+            if (target_[i] == 0)
+                positions[k] = i;
+        }
+
+        std::vector<std::uint64_t> current{encode(positions, k + 1)};
+        std::vector<std::uint64_t> next;
+        for (std::uint8_t depth = 0; !current.empty(); ++depth) {
+            // Free moves append to current while it is scanned
+            for (std::size_t c = 0; c < current.size(); ++c) {
+                auto state = current[c];
+                for (int i = 0; i <= k; ++i, state >>= BITS)
+                    positions[i] = static_cast<int>(state & MASK);
+                auto rank = impl::rankPlacement(positions, k, SIZE);
+                auto blank = positions[k];
+                if (visited[rank * SIZE + blank])
+                    continue;
+                visited[rank * SIZE + blank] = true;
+                if (table[rank] > depth)
+                    table[rank] = depth;
+
+                int neighbors[4], count = 0;
+                if (blank % N != 0)
+                    neighbors[count++] = blank - 1;
+                if (blank >= N)
+                    neighbors[count++] = blank - N;
+                if (blank % N != N - 1)
+                    neighbors[count++] = blank + 1;
+                if (blank < SIZE - N)
+                    neighbors[count++] = blank + N;
+
+                for (int m = 0; m < count; ++m) {
+                    auto cell = neighbors[m];
+                    int moved = -1;
+                    for (int j = 0; j < k; ++j)
+                        if (positions[j] == cell)
+                            moved = j;
+                    positions[k] = cell;
+                    if (moved < 0) {
+                        if (!visited[rank * SIZE + cell])
+                            current.push_back(encode(positions, k + 1));
+                    } else {
+                        positions[moved] = blank;
+                        next.push_back(encode(positions, k + 1));
+                        positions[moved] = cell;
+                    }
+                    positions[k] = blank;
+                }
+            }
+            current.swap(next);
+            next.clear();
+        }
+    }
+
+    template<std::uint8_t N>
+    int PatternDatabase<N>::operator()(const Board<N> &board) const noexcept {
+        std::array<int, SIZE> index;
+        for (int i = 0; i < SIZE; ++i)
+            index[board[i]] = i;
+
+        int h = 0;
+        int positions[MAX_PATTERN];
+        for (std::size_t p = 0; p < patterns_.size(); ++p) {
+            const auto &pattern = patterns_[p];
+            const int k = static_cast<int>(pattern.size());
+            for (int j = 0; j < k; ++j)
+                positions[j] = index[pattern[j]];
+            h += tables_[p][impl::rankPlacement(positions, k, SIZE)];
+        }
+        return h;
+    }
+
+    // File layout: "NPDB", version, N, pattern count, reserved byte, the target pieces,
+    // then the size and pieces of every pattern, then every table one byte per entry.
+    template<std::uint8_t N>
+    bool PatternDatabase<N>::save(const std::string &path) const {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os)
+            return false;
+
+        std::vector<std::uint8_t> header{'N', 'P', 'D', 'B', VERSION, N,
+                                         static_cast<std::uint8_t>(patterns_.size()), 0};
+        for (int i = 0; i < SIZE; ++i)
+            header.push_back(target_[i]);
+        for (const auto &pattern : patterns_) {
+            header.push_back(static_cast<std::uint8_t>(pattern.size()));
+            header.insert(header.end(), pattern.begin(), pattern.end());
+        }
+        os.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+        for (std::size_t p = 0; p < patterns_.size(); ++p) {
+            auto size = impl::placements(SIZE, static_cast<int>(patterns_[p].size()));
+            os.write(reinterpret_cast<const char *>(tables_[p]), static_cast<std::streamsize>(size));
+        }
+        return static_cast<bool>(os);
+    }
+
+    template<std::uint8_t N>
+    std::unique_ptr<PatternDatabase<N>> PatternDatabase<N>::load(const Board<N> &target, const std::string &path) {
+        io::MappedFile file(path);
+        if (!file.isOpen())
+            return nullptr;
+
+        const auto *data = file.data();
+        const auto size = file.size();
+        std::size_t offset = 8 + SIZE;
+        if (size < offset || !std::equal(data, data + 4, "NPDB") || data[4] != VERSION || data[5] != N)
+            return nullptr;
+        for (int i = 0; i < SIZE; ++i)
+            if (data[8 + i] != target[i])
+                return nullptr;
+
+        std::vector<Pattern> patterns(data[6]);
+        std::size_t total = 0;
+        // Pieces index the board and the sums are only admissible for disjoint patterns
+        std::vector<bool> taken(SIZE, false);
+        for (auto &pattern : patterns) {
+            if (offset >= size || data[offset] > MAX_PATTERN)
+                return nullptr;
+            auto k = data[offset++];
+            if (offset + k > size)
+                return nullptr;
+            for (int j = 0; j < k; ++j) {
+                auto piece = data[offset + j];
+                if (piece == 0 || piece >= SIZE || taken[piece])
+                    return nullptr;
+                taken[piece] = true;
+            }
+            pattern.assign(data + offset, data + offset + k);
+            offset += k;
+            total += impl::placements(SIZE, k);
+        }
+        if (size != offset + total)
+            return nullptr;
+
+        std::unique_ptr<PatternDatabase> pdb(new PatternDatabase(target, std::move(patterns), std::move(file)));
+        for (const auto &pattern : pdb->patterns_) {
+            pdb->tables_.push_back(pdb->file_.data() + offset);
+            offset += impl::placements(SIZE, static_cast<int>(pattern.size()));
+        }
+        return pdb;
+    }
+
+    template<std::uint8_t N>
+    std::vector<typename PatternDatabase<N>::Pattern> PatternDatabase<N>::split(std::initializer_list<int> sizes) {
+        std::vector<Pattern> patterns;
+        int piece = 1;
+        for (auto size : sizes) {
+            Pattern pattern;
+            for (int i = 0; i < size && piece < SIZE; ++i)
+                pattern.push_back(static_cast<Piece>(piece++));
+            patterns.push_back(std::move(pattern));
+        }
+        return patterns;
+    }
+
+    template<std::uint8_t N>
+    std::vector<typename PatternDatabase<N>::Pattern> PatternDatabase<N>::defaultPatterns() {
+        switch (N) {
+            case 3:
+                return split({8});
+            case 4:
+                return split({6, 6, 3});
+            case 5:
+                return split({6, 6, 6, 6});
+            default: {
+                std::vector<Pattern> patterns;
+                for (int piece = 1; piece < SIZE;) {
+                    Pattern pattern;
+                    for (int i = 0; i < 5 && piece < SIZE; ++i)
+                        pattern.push_back(static_cast<Piece>(piece++));
+                    patterns.push_back(std::move(pattern));
+                }
+                return patterns;
+            }
+        }
+    }
+}
+
+#endif //NPUZZLE_PATTERNDATABASE_H
@@ -0,0 +1,139 @@
+#ifndef NPUZZLE_RANKING_H
+#define NPUZZLE_RANKING_H
+
+#include <cstdint>
+#include <array>
+#include <bitset>
+
+#include "Board.h"
+
+namespace board {
+    namespace impl {
+        inline int popcount(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_popcountll(value);
+#else
+            return static_cast<int>(std::bitset<64>(value).count());
+#endif
+        }
+
+        // Number of ordered placements of k distinct pieces on n cells
+        constexpr std::uint64_t placements(int n, int k) noexcept {
+            std::uint64_t count = 1;
+            for (int i = 0; i < k; ++i)
+                count *= static_cast<std::uint64_t>(n - i);
+            return count;
+        }
+
+        // Mixed radix rank of k distinct positions among n cells, dense in [0, placements(n, k)):
+        // each position counts the free cells below it, found with one popcount
+        inline std::uint64_t rankPlacement(const int *positions, int k, int n) noexcept {
+            std::uint64_t used = 0;
+            std::uint64_t rank = 0;
+            for (int i = 0; i < k; ++i) {
+                auto p = positions[i];
+                auto smaller = popcount(used & ((std::uint64_t{1} << p) - 1));
+                rank = rank * static_cast<std::uint64_t>(n - i) + static_cast<std::uint64_t>(p - smaller);
+                used |= std::uint64_t{1} << p;
+            }
+            return rank;
+        }
+
+        // Inverse of rankPlacement()
+        inline void unrankPlacement(std::uint64_t rank, int *positions, int k, int n) noexcept {
+            for (int i = k; i-- > 0;) {
+                positions[i] = static_cast<int>(rank % static_cast<std::uint64_t>(n - i));
+                rank /= static_cast<std::uint64_t>(n - i);
+            }
+            // Each digit picks among the cells still free, in increasing order
+            std::uint64_t used = 0;
+            for (int i = 0; i < k; ++i) {
+                auto free = positions[i];
+                int p = 0;
+                for (;; ++p)
+                    if ((used >> p & 1) == 0 && free-- == 0)
+                        break;
+                positions[i] = p;
+                used |= std::uint64_t{1} << p;
+            }
+        }
+    }
+
+    // Bijections between boards and dense integers, a perfect hash that can be inverted. A board
+    // ranks by the positions of its pieces, blank first, so boards with the blank on the same
+    // cell are numbered together. Up to 4x4, 16! still fits in 64 bits.
+    template<std::uint8_t N>
+    class Ranking {
+    public:
+        static constexpr int SIZE = Board<N>::SIZE;
+
+        static_assert(SIZE <= 20, "20! is the largest factorial that fits in 64 bits");
+
+        static constexpr std::uint64_t PERMUTATIONS = impl::placements(SIZE, SIZE);
+
+        // Boards of one parity, all of them reachable from each other
+        static constexpr std::uint64_t REACHABLE = PERMUTATIONS / 2;
+
+        // Rank in [0, PERMUTATIONS)
+        static std::uint64_t rank(const Board<N> &board) noexcept {
+            int positions[SIZE];
+            locate(board, positions);
+            return impl::rankPlacement(positions, SIZE, SIZE);
+        }
+
+        static Board<N> unrank(std::uint64_t rank) {
+            int positions[SIZE];
+            impl::unrankPlacement(rank, positions, SIZE, SIZE);
+            return place(positions);
+        }
+
+        // Rank in [0, REACHABLE) among the boards of the same parity. The last two pieces are left
+        // out: they fill the two cells left over, in the one order the parity allows.
+        static std::uint64_t rankReachable(const Board<N> &board) noexcept {
+            int positions[SIZE];
+            locate(board, positions);
+            return impl::rankPlacement(positions, SIZE - 2, SIZE);
+        }
+
+        // Inverse of rankReachable() for the boards of the given parity, see Board::parity()
+        static Board<N> unrankReachable(std::uint64_t rank, int parity) {
+            int positions[SIZE];
+            impl::unrankPlacement(rank, positions, SIZE - 2, SIZE);
+            std::uint64_t used = 0;
+            for (int i = 0; i < SIZE - 2; ++i)
+                used |= std::uint64_t{1} << positions[i];
+            for (int i = SIZE - 2, p = 0; i < SIZE; ++i, ++p) {
+                while (used >> p & 1)
+                    ++p;
+                positions[i] = p;
+            }
+            auto board = place(positions);
+            if (board.parity() == parity)
+                return board;
+            // Swapping two pieces flips the parity and leaves the blank where it is
+            std::swap(positions[SIZE - 2], positions[SIZE - 1]);
+            return place(positions);
+        }
+
+    private:
+        static void locate(const Board<N> &board, int *positions) noexcept {
+            for (int i = 0; i < SIZE; ++i)
+                positions[board[i]] = i;
+        }
+
+        static Board<N> place(const int *positions) {
+            std::array<typename Board<N>::Piece, SIZE> grid;
+            for (int piece = 0; piece < SIZE; ++piece)
+                grid[positions[piece]] = static_cast<typename Board<N>::Piece>(piece);
+            return Board<N>(grid);
+        }
+    };
+
+    template<std::uint8_t N>
+    constexpr std::uint64_t Ranking<N>::PERMUTATIONS;
+
+    template<std::uint8_t N>
+    constexpr std::uint64_t Ranking<N>::REACHABLE;
+}
+
+#endif //NPUZZLE_RANKING_H
@@ -0,0 +1,124 @@
+#ifndef NPUZZLE_REDUCTION_H
+#define NPUZZLE_REDUCTION_H
+
+#include <algorithm>
+#include <vector>
+
+#include "BeamSearch.h"
+#include "DynamicBoard.h"
+#include "GraphSearch.h"
+
+namespace board {
+    namespace impl {
+        // Adds the counters of one stage to those of the whole search
+        inline void accumulate(search::Statistics &total, const search::Statistics &stage) {
+            total.expanded += stage.expanded;
+            total.generated += stage.generated;
+            total.duplicates += stage.duplicates;
+            total.peak_open = std::max(total.peak_open, stage.peak_open);
+            total.peak_closed = std::max(total.peak_closed, stage.peak_closed);
+            total.peak_memory = std::max(total.peak_memory, stage.peak_memory);
+        }
+    }
+
+    // Solves a board of any size the way people do: one outer row and one outer column of the
+    // square left at a time, on the sides away from the target's blank, until a 3x3 square is
+    // left for A*, or the board itself if it is no larger. Every stage is a beam search on the
+    // square with the pieces that do not belong in its row and column all made ANY. A beam over
+    // the whole board gets within a few moves of the target and then drifts on a plateau of
+    // nearly solved boards; the stages are small enough not to. Stages share the limits,
+    // FAILED if one of them finds nothing or they run out.
+    inline search::Result reductionSearch(const DynamicBoard &start, const DynamicBoard &target,
+                                          const search::BeamOptions &options = search::BeamOptions(),
+                                          const search::Limits &limits = search::Limits()) {
+        using search::Result;
+
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+        if (!solvable(start, target)) {
+            return {Result::UNSOLVABLE, 0};
+        }
+
+        search::impl::Stopwatch stopwatch;
+        search::Statistics stats;
+        std::int64_t steps = 0;
+        std::vector<int> moves;
+        auto board = start;
+        const auto side = start.side();
+        int top = 0;
+        int left = 0;
+        for (int square = side;; --square) {
+            auto last = square <= 3;
+            // The target's blank stays inside the square, the row and column go from the far sides
+            auto blank = target.blankIndex();
+            auto row = blank / side - top != 0 ? 0 : square - 1;
+            auto column = blank % side - left != 0 ? 0 : square - 1;
+            std::vector<DynamicBoard::Piece> from;
+            std::vector<DynamicBoard::Piece> to;
+            std::vector<bool> staged(DynamicBoard::ANY + 1, false);
+            for (int r = 0; r < square; ++r)
+                for (int c = 0; c < square; ++c)
+                    staged[target[(top + r) * side + left + c]] = last || r == row || c == column;
+            for (int r = 0; r < square; ++r)
+                for (int c = 0; c < square; ++c) {
+                    auto cell = (top + r) * side + left + c;
+                    from.push_back(staged[board[cell]] || board[cell] == 0 ? board[cell] : DynamicBoard::ANY);
+                    to.push_back(staged[target[cell]] || target[cell] == 0 ? target[cell] : DynamicBoard::ANY);
+                }
+
+            DynamicBoard reduced(square, std::move(from));
+            DynamicBoard reduced_target(square, std::move(to));
+            DynamicGoal goal(reduced_target);
+            reduced.setGoal(goal);
+            // Counted from the start of the first stage
+            auto budget = limits;
+            auto expanded = stats.expanded;
+            budget.max_expanded = limits.max_expanded - expanded;
+            if (limits.progress) {
+                budget.progress = [&limits, expanded](const search::Progress &progress) {
+                    limits.progress({progress.bound, expanded + progress.expanded});
+                };
+            }
+            Result result;
+            if (last) {
+                result = search::aStar(reduced, reduced_target,
+                                       [](const search::Node<DynamicBoard> &node) {
+                                           return node.getDepth();
+                                       },
+                                       [](const search::Node<DynamicBoard> &node) {
+                                           return node.get().manhattan();
+                                       },
+                                       budget);
+            } else {
+                result = search::beamSearch(reduced, reduced_target, [](const DynamicBoard &state) {
+                    return state.manhattan();
+                }, options, budget);
+            }
+            steps += result.steps();
+            board::impl::accumulate(stats, result.stats());
+            if (!result.success()) {
+                stopwatch.lap(stats, "search");
+                return {Result::FAILED, steps, std::move(stats)};
+            }
+
+            // The blank never leaves the square, so the moves are the same on the whole board
+            for (auto move : result.path().moves<Move>()) {
+                board.moveBlank(move);
+                moves.push_back(static_cast<int>(move));
+            }
+            if (last)
+                break;
+            top += row == 0;
+            left += column == 0;
+        }
+
+        search::Path path(moves.size());
+        for (std::size_t i = 0; i < moves.size(); ++i)
+            path.set(i, moves[i]);
+        stopwatch.lap(stats, "search");
+        return {Result::SUCCESS, steps, std::move(stats), std::move(path)};
+    }
+}
+
+#endif //NPUZZLE_REDUCTION_H
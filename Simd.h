@@ -0,0 +1,186 @@
+#ifndef NPUZZLE_SIMD_H
+#define NPUZZLE_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(NPUZZLE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define NPUZZLE_SSE2 1
+#include <immintrin.h>
+#else
+#define NPUZZLE_SSE2 0
+#endif
+
+// The AVX2 kernels are compiled on any SSE2 GCC or Clang build so they can be measured against
+// the others, but boards only use them when the whole build targets AVX2
+#if NPUZZLE_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#define NPUZZLE_HAS_AVX2_KERNELS 1
+#define NPUZZLE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NPUZZLE_HAS_AVX2_KERNELS 0
+#endif
+
+// Byte kernels over boards stored in whole 16-byte blocks. Both operands must have the same
+// bytes, a multiple of 16, and the padding past the last cell must be zero in both.
+namespace simd {
+    namespace impl {
+        // Without the popcnt instruction the builtin becomes a library call, the bit trick is faster
+        inline int popcount(std::uint32_t value) noexcept {
+#if defined(__POPCNT__)
+            return __builtin_popcount(value);
+#else
+            value = value - ((value >> 1) & 0x55555555U);
+            value = (value & 0x33333333U) + ((value >> 2) & 0x33333333U);
+            value = (value + (value >> 4)) & 0x0F0F0F0FU;
+            return static_cast<int>((value * 0x01010101U) >> 24);
+#endif
+        }
+
+        inline int lowestBit(std::uint32_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctz(value);
+#else
+            int bit = 0;
+            for (; (value & 1) == 0; value >>= 1)
+                ++bit;
+            return bit;
+#endif
+        }
+    }
+
+    namespace scalar {
+        // Cells where rhs holds a piece and lhs a different one
+        inline int mismatches(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+            int count = 0;
+            for (std::size_t i = 0; i < bytes; ++i)
+                count += rhs[i] != 0 && lhs[i] != rhs[i];
+            return count;
+        }
+
+        inline bool equal(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+            for (std::size_t i = 0; i < bytes; ++i)
+                if (lhs[i] != rhs[i])
+                    return false;
+            return true;
+        }
+
+        // First index holding value, bytes if there is none
+        inline std::size_t find(const std::uint8_t *data, std::size_t bytes, std::uint8_t value) noexcept {
+            std::size_t i = 0;
+            while (i < bytes && data[i] != value)
+                ++i;
+            return i;
+        }
+    }
+
+#if NPUZZLE_SSE2
+    namespace sse2 {
+        inline int mismatches(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+            int count = 0;
+            auto zero = _mm_setzero_si128();
+            for (std::size_t i = 0; i < bytes; i += 16) {
+                auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+                auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+                // Lanes that are equal or blank in rhs do not count
+                auto skip = _mm_or_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(b, zero));
+                count += 16 - impl::popcount(static_cast<std::uint32_t>(_mm_movemask_epi8(skip)));
+            }
+            return count;
+        }
+
+        inline bool equal(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+            for (std::size_t i = 0; i < bytes; i += 16) {
+                auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+                auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF)
+                    return false;
+            }
+            return true;
+        }
+
+        inline std::size_t find(const std::uint8_t *data, std::size_t bytes, std::uint8_t value) noexcept {
+            auto needle = _mm_set1_epi8(static_cast<char>(value));
+            for (std::size_t i = 0; i < bytes; i += 16) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+                if (mask != 0)
+                    return i + static_cast<std::size_t>(impl::lowestBit(mask));
+            }
+            return bytes;
+        }
+    }
+#endif
+
+#if NPUZZLE_HAS_AVX2_KERNELS
+    // For bytes a multiple of 32, the rest is left to the SSE2 kernels
+    namespace avx2 {
+        NPUZZLE_TARGET_AVX2
+        inline int mismatches(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+            int count = 0;
+            auto zero = _mm256_setzero_si256();
+            for (std::size_t i = 0; i < bytes; i += 32) {
+                auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+                auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+                auto skip = _mm256_or_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(b, zero));
+                count += 32 - impl::popcount(static_cast<std::uint32_t>(_mm256_movemask_epi8(skip)));
+            }
+            return count;
+        }
+
+        NPUZZLE_TARGET_AVX2
+        inline bool equal(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+            for (std::size_t i = 0; i < bytes; i += 32) {
+                auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+                auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+                if (static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b))) != 0xFFFFFFFFU)
+                    return false;
+            }
+            return true;
+        }
+
+        NPUZZLE_TARGET_AVX2
+        inline std::size_t find(const std::uint8_t *data, std::size_t bytes, std::uint8_t value) noexcept {
+            auto needle = _mm256_set1_epi8(static_cast<char>(value));
+            for (std::size_t i = 0; i < bytes; i += 32) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+                if (mask != 0)
+                    return i + static_cast<std::size_t>(impl::lowestBit(mask));
+            }
+            return bytes;
+        }
+    }
+#endif
+
+    // The kernels the build targets, chosen at compile time. Only mismatches() gains from AVX2:
+    // equal() and find() mostly stop within the first 16 bytes, where SSE2 is quicker.
+    inline int mismatches(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+#if NPUZZLE_HAS_AVX2_KERNELS && defined(__AVX2__)
+        if (bytes % 32 == 0)
+            return avx2::mismatches(lhs, rhs, bytes);
+#endif
+#if NPUZZLE_SSE2
+        return sse2::mismatches(lhs, rhs, bytes);
+#else
+        return scalar::mismatches(lhs, rhs, bytes);
+#endif
+    }
+
+    inline bool equal(const std::uint8_t *lhs, const std::uint8_t *rhs, std::size_t bytes) noexcept {
+#if NPUZZLE_SSE2
+        return sse2::equal(lhs, rhs, bytes);
+#else
+        return scalar::equal(lhs, rhs, bytes);
+#endif
+    }
+
+    inline std::size_t find(const std::uint8_t *data, std::size_t bytes, std::uint8_t value) noexcept {
+#if NPUZZLE_SSE2
+        return sse2::find(data, bytes, value);
+#else
+        return scalar::find(data, bytes, value);
+#endif
+    }
+}
+
+#endif //NPUZZLE_SIMD_H
@@ -0,0 +1,171 @@
+#ifndef NPUZZLE_SOLVER_H
+#define NPUZZLE_SOLVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Batch.h"
+
+// Solving instances on a pool of threads without blocking the caller, for a service where every
+// request has a deadline: submit() queues an instance and returns at once, and its Job tells
+// when the outcome is there and can stop the search early.
+namespace batch {
+    // What a running search reports, see search::Progress
+    using ProgressCallback = std::function<void(const search::Progress &)>;
+
+    // A submitted instance. Cancelling is cooperative: the search stops at its next check of its
+    // limits, every search::Limits::CLOCK_INTERVAL expansions, and the outcome then has the
+    // status "cancelled"; an instance cancelled before it started is not searched at all.
+    class Job {
+    public:
+        Job() = default;
+
+        std::future<Outcome> &outcome() {
+            return outcome_;
+        }
+
+        void cancel() {
+            if (cancelled_)
+                cancelled_->store(true, std::memory_order_relaxed);
+        }
+
+    private:
+        friend class Solver;
+
+        Job(std::future<Outcome> outcome, std::shared_ptr<std::atomic<bool>> cancelled)
+                : outcome_(std::move(outcome)), cancelled_(std::move(cancelled)) {}
+
+        std::future<Outcome> outcome_;
+        std::shared_ptr<std::atomic<bool>> cancelled_;
+    };
+
+    class Solver {
+    public:
+        // Distance tables for Algorithm::TABLE are loaded from or saved to table, see Options::table
+        explicit Solver(unsigned threads = std::thread::hardware_concurrency(), std::string table = std::string())
+                : tables_(std::move(table)) {
+            threads = threads == 0 ? 1 : threads;
+            running_.resize(threads);
+            for (unsigned i = 0; i < threads; ++i)
+                workers_.emplace_back(&Solver::work, this, i);
+        }
+
+        Solver(const Solver &) = delete;
+
+        Solver &operator=(const Solver &) = delete;
+
+        // Cancels the instances still queued or running and waits for the threads
+        ~Solver() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+                for (auto &task : tasks_)
+                    task.cancelled->store(true, std::memory_order_relaxed);
+                for (auto &cancelled : running_)
+                    if (cancelled)
+                        cancelled->store(true, std::memory_order_relaxed);
+            }
+            ready_.notify_all();
+            for (auto &worker : workers_)
+                worker.join();
+        }
+
+        // Queues an instance, solved with options as in batch mode; the budget, options.milliseconds
+        // and options.max_expanded, runs from when it starts, and options.deadline holds anyway.
+        // progress, if given, is called on the solving thread about every progress_interval
+        // expansions of the engines that take search::Limits.
+        Job submit(Instance instance, const Options &options, ProgressCallback progress = ProgressCallback(),
+                   std::int64_t progress_interval = search::Limits().progress_interval) {
+            Task task;
+            task.instance = std::move(instance);
+            task.options = options;
+            task.progress = std::move(progress);
+            task.progress_interval = progress_interval;
+            task.cancelled = std::make_shared<std::atomic<bool>>(false);
+            Job job(task.promise.get_future(), task.cancelled);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            ready_.notify_one();
+            return job;
+        }
+
+        // An input line in the format of batch mode
+        Job submit(const std::string &line, const Options &options, ProgressCallback progress = ProgressCallback(),
+                   std::int64_t progress_interval = search::Limits().progress_interval) {
+            Instance instance;
+            if (!impl::parse(line, instance))
+                instance.error = "pieces must be integers";
+            return submit(std::move(instance), options, std::move(progress), progress_interval);
+        }
+
+    private:
+        struct Task {
+            Instance instance;
+            Options options;
+            ProgressCallback progress;
+            std::int64_t progress_interval;
+            std::shared_ptr<std::atomic<bool>> cancelled;
+            std::promise<Outcome> promise;
+        };
+
+        void work(unsigned index) {
+            impl::Workspaces workspaces;
+            while (true) {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ready_.wait(lock, [this] {
+                        return !tasks_.empty() || closed_;
+                    });
+                    if (tasks_.empty())
+                        return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                    running_[index] = task.cancelled;
+                }
+
+                try {
+                    auto limits = impl::limits(task.options);
+                    limits.cancel = task.cancelled.get();
+                    limits.progress = std::move(task.progress);
+                    limits.progress_interval = task.progress_interval;
+                    Outcome outcome;
+                    if (limits.cancelled()) {
+                        outcome.id = task.instance.id;
+                        outcome.status = "cancelled";
+                    } else {
+                        outcome = impl::solve(task.instance, task.options, limits, workspaces, tables_);
+                    }
+                    task.promise.set_value(std::move(outcome));
+                } catch (...) {
+                    task.promise.set_exception(std::current_exception());
+                }
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_[index] = nullptr;
+            }
+        }
+
+        impl::Tables tables_;
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<Task> tasks_;
+        // Cancel flags of the instances being solved, one slot per thread
+        std::vector<std::shared_ptr<std::atomic<bool>>> running_;
+        bool closed_ = false;
+        std::vector<std::thread> workers_;
+    };
+}
+
+#endif //NPUZZLE_SOLVER_H
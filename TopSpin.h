@@ -0,0 +1,171 @@
+#ifndef NPUZZLE_TOPSPIN_H
+#define NPUZZLE_TOPSPIN_H
+
+#include <cstdint>
+#include <array>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+// The (N, K) TopSpin puzzle, a second state type for the search engines: N tokens on a circular
+// track that can be rotated either way, with a turnstile that reverses the K tokens in it
+namespace topspin {
+    enum class Move : std::uint8_t {
+        LEFT, RIGHT, FLIP, IDLE
+    };
+
+    inline Move &operator++(Move &m) {
+        return m = m == Move::IDLE ? Move::LEFT : static_cast<Move>(static_cast<int>(m) + 1);
+    }
+
+    constexpr Move inverse(Move m) {
+        return m == Move::LEFT ? Move::RIGHT : m == Move::RIGHT ? Move::LEFT : m;
+    }
+
+    constexpr char symbol(Move m) {
+        return m == Move::LEFT ? 'L' : m == Move::RIGHT ? 'R' : m == Move::FLIP ? 'F' : '-';
+    }
+
+    // The track packed 4 bits to a token, the token in the turnstile's first cell lowest
+    template<int N, int K = 4>
+    class TopSpin {
+        static_assert(N <= 16 && K >= 2 && K <= N, "the track fits one 64-bit word");
+
+    public:
+        using Move = topspin::Move;
+
+        using Token = std::uint8_t;
+
+        static constexpr int SIZE = N;
+
+        // Tokens in order around the track
+        TopSpin() noexcept {
+            for (int i = 0; i < N; ++i)
+                packed_ |= static_cast<std::uint64_t>(i) << 4 * i;
+        }
+
+        TopSpin(std::initializer_list<Token> tokens) noexcept {
+            int i = 0;
+            for (auto token : tokens)
+                packed_ |= static_cast<std::uint64_t>(token & 0xF) << 4 * i++;
+        }
+
+        explicit TopSpin(const std::array<Token, N> &tokens) noexcept {
+            for (int i = 0; i < N; ++i)
+                packed_ |= static_cast<std::uint64_t>(tokens[i] & 0xF) << 4 * i;
+        }
+
+        Token operator[](int i) const noexcept {
+            return static_cast<Token>(packed_ >> 4 * i & 0xF);
+        }
+
+        bool operator==(const TopSpin &rhs) const noexcept {
+            return packed_ == rhs.packed_;
+        }
+
+        bool operator!=(const TopSpin &rhs) const noexcept {
+            return packed_ != rhs.packed_;
+        }
+
+        std::uint64_t pack() const noexcept {
+            return packed_;
+        }
+
+        std::size_t hashCode() const noexcept {
+            auto z = packed_ * 0x9E3779B97F4A7C15ULL;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            return static_cast<std::size_t>(z ^ (z >> 31));
+        }
+
+        // Every move applies anywhere, LEFT moves the token in the turnstile's first cell to the
+        // far end of the track
+        bool apply(Move move) noexcept {
+            switch (move) {
+                case Move::LEFT:
+                    packed_ = packed_ >> 4 | (packed_ & 0xF) << 4 * (N - 1);
+                    return true;
+                case Move::RIGHT:
+                    packed_ = (packed_ << 4 & MASK) | packed_ >> 4 * (N - 1);
+                    return true;
+                case Move::FLIP: {
+                    auto flipped = packed_ & ~TURNSTILE;
+                    for (int i = 0; i < K; ++i)
+                        flipped |= (packed_ >> 4 * i & 0xF) << 4 * (K - 1 - i);
+                    packed_ = flipped;
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        // Number of inversions modulo 2
+        int parity() const noexcept {
+            int inversions = 0;
+            for (int i = 0; i < N; ++i)
+                for (int j = i + 1; j < N; ++j)
+                    inversions += (*this)[i] > (*this)[j];
+            return inversions % 2;
+        }
+
+    private:
+        static constexpr std::uint64_t MASK = N == 16 ? ~std::uint64_t{0} : (std::uint64_t{1} << 4 * N) - 1;
+
+        static constexpr std::uint64_t TURNSTILE = K == 16 ? ~std::uint64_t{0} : (std::uint64_t{1} << 4 * K) - 1;
+
+        std::uint64_t packed_ = 0;
+    };
+
+    // A rotation is an N-cycle and a flip K / 2 swaps. When both are even permutations only the
+    // arrangements of the same parity are reachable, otherwise all of them are for the usual
+    // sizes; (8, 4), (7, 3) and (8, 2) are checked by breadth first search.
+    template<int N, int K>
+    inline bool solvable(const TopSpin<N, K> &start, const TopSpin<N, K> &target) noexcept {
+        if ((N - 1) % 2 == 1 || K / 2 % 2 == 1)
+            return true;
+        return start.parity() == target.parity();
+    }
+
+    // Tokens that are next to each other on the track but not around the target. Moves keep the
+    // circle of tokens apart from the two ends of the turnstile, so a flip mends at most two of
+    // them and half their number, rounded up, is an admissible heuristic.
+    template<int N, int K>
+    class Breakpoints {
+    public:
+        explicit Breakpoints(const TopSpin<N, K> &target) noexcept {
+            for (int i = 0; i < N; ++i)
+                next_[target[i]] = target[(i + 1) % N];
+        }
+
+        int operator()(const TopSpin<N, K> &state) const noexcept {
+            int breakpoints = 0;
+            for (int i = 0; i < N; ++i) {
+                auto a = state[i];
+                auto b = state[(i + 1) % N];
+                breakpoints += next_[a] != b && next_[b] != a;
+            }
+            return (breakpoints + 1) / 2;
+        }
+
+    private:
+        std::array<std::uint8_t, 16> next_{};
+    };
+
+    template<int N, int K>
+    std::ostream &operator<<(std::ostream &os, const TopSpin<N, K> &state) {
+        for (int i = 0; i < N; ++i)
+            os << std::to_string(state[i]) << (i + 1 == K ? " | " : " ");
+        return os << '\n';
+    }
+}
+
+namespace std {
+    template<int N, int K>
+    struct hash<topspin::TopSpin<N, K>> {
+        std::size_t operator()(const topspin::TopSpin<N, K> &state) const noexcept {
+            return state.hashCode();
+        }
+    };
+}
+
+#endif //NPUZZLE_TOPSPIN_H
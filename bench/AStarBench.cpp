@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "../Board.h"
+#include "../GraphSearch.h"
+#include "Instances.h"
+#include "LegacySearch.h"
+
+using board::Board;
+using search::Result;
+
+namespace {
+    using instances::EASY_4X4;
+    using instances::GOAL_4X4;
+
+    // Generic so they serve both the legacy and the current node type
+    const auto depth = [](const auto &node) {
+        return node.getDepth();
+    };
+
+    const auto manhattan = [](const auto &node) {
+        return GOAL_4X4.similarityCalculate(node.get());
+    };
+
+    template<typename Solver>
+    void run(const char *name, Solver solver) {
+        std::int64_t total_nodes = 0;
+        double total_seconds = 0;
+        for (std::size_t i = 0; i < EASY_4X4.size(); ++i) {
+            auto begin = std::chrono::steady_clock::now();
+            Result result = solver(EASY_4X4[i]);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            total_nodes += result.steps();
+            total_seconds += elapsed.count();
+            std::printf("%-8s #%zu %-7s %10lld nodes %10.3f s %12.0f nodes/s\n", name, i,
+                        result.success() ? "solved" : "failed", static_cast<long long>(result.steps()),
+                        elapsed.count(), result.steps() / elapsed.count());
+        }
+        std::printf("%-8s total   %10lld nodes %10.3f s %12.0f nodes/s\n\n", name,
+                    static_cast<long long>(total_nodes), total_seconds, total_nodes / total_seconds);
+    }
+}
+
+int main() {
+    // The legacy engine traces every node to std::cout, keep that out of the measurement
+    auto buf = std::cout.rdbuf(nullptr);
+
+    run("legacy", [](const Board<4> &start) {
+        return legacy::aStar<Board<4>>(start, GOAL_4X4, depth, manhattan);
+    });
+    run("heap", [](const Board<4> &start) {
+        return search::aStar<Board<4>>(start, GOAL_4X4, depth, manhattan);
+    });
+
+    std::cout.rdbuf(buf);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef NPUZZLE_INSTANCES_H
+#define NPUZZLE_INSTANCES_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../Board.h"
+
+// Fixed instances shared by the benchmarks, all random walks from GOAL_4X4 so runs stay comparable
+namespace instances {
+    using board::Board;
+
+    const Board<4> GOAL_4X4 = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0};
+
+    // Solved by the sorted-list A* within seconds
+    const std::vector<Board<4>> EASY_4X4 = {
+            {2, 7, 4, 8, 13, 3, 1, 0, 6, 10, 5, 15, 14, 9, 12, 11},
+            {5, 3, 4, 8, 2, 1, 6, 15, 10, 13, 0, 11, 9, 14, 7, 12},
+            {12, 5, 7, 2, 1, 0, 10, 4, 14, 3, 11, 8, 9, 6, 13, 15},
+            {1, 3, 11, 2, 9, 7, 10, 4, 13, 5, 0, 8, 14, 6, 15, 12},
+            {1, 2, 8, 3, 5, 6, 4, 12, 0, 7, 9, 15, 10, 13, 14, 11},
+            {9, 5, 1, 6, 10, 14, 2, 3, 0, 7, 4, 11, 13, 15, 12, 8},
+            {1, 2, 3, 12, 5, 0, 4, 6, 13, 7, 11, 15, 10, 9, 8, 14},
+            {5, 6, 3, 2, 4, 1, 7, 8, 9, 14, 0, 10, 13, 15, 12, 11},
+    };
+
+    // Tens to hundreds of thousands of A* expansions with the Manhattan distance
+    const std::vector<Board<4>> MEDIUM_4X4 = {
+            {1, 2, 6, 3, 9, 11, 12, 4, 5, 7, 0, 15, 10, 13, 8, 14},
+            {6, 7, 8, 4, 2, 3, 5, 0, 1, 13, 10, 12, 14, 9, 11, 15},
+            {1, 3, 0, 7, 9, 14, 10, 2, 5, 6, 11, 4, 13, 15, 12, 8},
+            {1, 6, 2, 3, 5, 4, 14, 8, 9, 10, 12, 15, 11, 0, 13, 7},
+            {1, 10, 5, 4, 6, 0, 3, 2, 9, 15, 11, 7, 14, 13, 12, 8},
+            {0, 1, 8, 11, 6, 2, 14, 12, 3, 5, 9, 7, 13, 10, 4, 15},
+            {9, 1, 3, 4, 10, 5, 2, 8, 0, 12, 13, 15, 14, 6, 7, 11},
+            {6, 5, 3, 4, 13, 9, 2, 0, 10, 14, 7, 11, 12, 8, 1, 15},
+            {1, 3, 13, 4, 2, 9, 12, 8, 5, 11, 7, 15, 10, 0, 14, 6},
+            {6, 7, 1, 2, 10, 0, 3, 4, 5, 12, 9, 15, 13, 11, 8, 14},
+    };
+
+    // Boards reached from goal by count random walks of moves steps that never undo their last
+    // move, the same for the same seed on every platform
+    template<std::uint8_t N>
+    std::vector<Board<N>> randomWalks(const Board<N> &goal, std::size_t count, int moves, std::uint32_t seed) {
+        using board::Move;
+        std::mt19937 random(seed);
+        std::vector<Board<N>> boards;
+        boards.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            auto board = goal;
+            auto last = Move::IDLE;
+            for (int step = 0; step < moves;) {
+                auto move = static_cast<Move>(random() % 4);
+                if (move == inverse(last) || !board.moveBlank(move))
+                    continue;
+                last = move;
+                ++step;
+            }
+            boards.push_back(board);
+        }
+        return boards;
+    }
+}
+
+#endif //NPUZZLE_INSTANCES_H
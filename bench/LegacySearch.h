@@ -0,0 +1,182 @@
+#ifndef NPUZZLE_LEGACYSEARCH_H
+#define NPUZZLE_LEGACYSEARCH_H
+
+#include <algorithm>
+#include <forward_list>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "../GraphSearch.h"
+
+// The shared_ptr nodes and sorted forward_list A* that GraphSearch.h used before the binary heap
+// and the node pool, kept only as the baseline of the benchmarks.
+namespace legacy {
+    using search::Result;
+
+    template<typename E>
+    class Node;
+
+    template<typename E>
+    using NodePtr = std::shared_ptr<Node<E>>;
+
+    template<typename E>
+    class Node {
+    public:
+        explicit Node(const E &elem) : elem_(std::make_unique<E>(elem)) {}
+
+        explicit Node(std::unique_ptr<E> &&elem) : elem_(std::move(elem)) {}
+
+        bool operator==(const Node &rhs) const noexcept {
+            return *elem_ == *rhs.elem_;
+        }
+
+        void setParent(const NodePtr<E> &parent) {
+            parent_ = parent;
+        }
+
+        NodePtr<E> getParent() {
+            auto parent = parent_.lock();
+            if (!parent) {
+                parent_.reset();
+            }
+            return parent;
+        }
+
+        void setDepth(int depth) {
+            depth_ = depth;
+        }
+
+        int getDepth() const {
+            return depth_;
+        }
+
+        void setCost(int cost) {
+            cost_ = cost;
+        }
+
+        int getCost() const {
+            return cost_;
+        }
+
+        E &get() const {
+            return *elem_;
+        }
+
+        // Copies every successor to the heap the way Board::expand() used to
+        std::vector<NodePtr<E>> expand() {
+            std::vector<NodePtr<E>> children;
+            children.reserve(4);
+            elem_->expand([&children](const E &elem, typename E::Move) {
+                children.push_back(std::make_shared<Node>(std::make_unique<E>(elem)));
+            });
+            return children;
+        }
+
+    private:
+        std::unique_ptr<E> elem_;
+        std::weak_ptr<Node> parent_{};
+        int depth_ = 0;
+        int cost_ = 0;
+    };
+
+    template<typename E>
+    using Evaluator = std::function<int(const Node<E> &)>;
+
+    namespace impl {
+        template<typename InputIt, typename E>
+        inline InputIt find(InputIt first, InputIt last, const NodePtr<E> &target) {
+            return std::find_if(first, last, [target](const NodePtr<E> &node) {
+                return *node == *target;
+            });
+        }
+
+        template<typename E>
+        inline bool isNotSameWithAncestors(const NodePtr<E> &node) {
+            for (auto parent = node->getParent(); parent != nullptr; parent = parent->getParent())
+                if (*node == *parent)
+                    return false;
+            return true;
+        }
+
+        template<typename E>
+        std::vector<NodePtr<E>> expand(const NodePtr<E> &node) {
+            auto children = node->expand();
+            std::vector<NodePtr<E>> result;
+            result.reserve(4);
+            for (auto &child : children) {
+                child->setParent(node);
+                child->setDepth(node->getDepth() + 1);
+                if (isNotSameWithAncestors(child)) {
+                    result.push_back(std::move(child));
+                }
+            }
+            return result;
+        }
+
+        template<typename E>
+        inline void log(std::int64_t step, const NodePtr<E> &node) {
+            std::cout << "step " << step << std::endl;
+            std::cout << "depth " << node->getDepth() << std::endl;
+            std::cout << node->get() << std::endl;
+        }
+    }
+
+    template<typename E>
+    Result aStar(const E &start, const E &target, Evaluator<E> g, Evaluator<E> h) {
+        if (start == target) {
+            return {Result::SUCCESS, 0};
+        }
+
+        auto ps = std::make_shared<Node<E>>(start);
+        auto pt = std::make_shared<Node<E>>(target);
+        std::forward_list<NodePtr<E>> open;
+        std::forward_list<NodePtr<E>> closed;
+        std::int64_t steps = 0;
+
+        open.push_front(ps);
+        while (!open.empty()) {
+            open.sort([](const NodePtr<E> &lhs, const NodePtr<E> &rhs) {
+                return lhs->getCost() < rhs->getCost();
+            });
+            closed.push_front(open.front());
+            open.pop_front();
+
+            auto pbn = closed.front();
+
+            ++steps;
+            impl::log(steps, pbn);
+
+            if (*pbn == *pt) {
+                return {Result::SUCCESS, steps};
+            }
+
+            auto children = impl::expand(pbn);
+            for (auto it = children.begin(); it != children.end(); ++it) {
+                auto &child = *it;
+                auto hv = h(*child);
+                auto iter = impl::find(open.begin(), open.end(), child);
+                if (iter != open.end() && g(*child) < g(*(*iter))) {
+                    auto &old = *iter;
+                    old->setParent(pbn);
+                    old->setCost(g(*child) + hv);
+                } else if ((iter = impl::find(closed.begin(), closed.end(), child)) != closed.end() &&
+                           g(*child) < g(*(*iter))) {
+                    auto &old = *iter;
+                    old->setParent(pbn);
+                    old->setCost(g(*child) + hv);
+                    open.push_front(old);
+                    closed.remove(old);
+                } else {
+                    child->setCost(g(*child) + hv);
+                    open.push_front(child);
+                }
+            }
+        }
+
+        return {Result::FAILED, steps};
+    }
+}
+
+#endif //NPUZZLE_LEGACYSEARCH_H
@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include "../Batch.h"
+#include "../Board.h"
+#include "../BoundedSearch.h"
+#include "../GraphSearch.h"
+#include "../Heuristics.h"
+#include "../ParallelSearch.h"
+#include "Instances.h"
+
+// Runs every engine over fixed instance suites and prints one machine readable record per
+// suite and engine. Given the output of an earlier run as --baseline, it also reports every
+// median that got slower by more than the tolerance, and every change in expanded nodes, and
+// exits with 1 if there was any.
+using board::Board;
+using board::Goal;
+using search::Node;
+using search::Result;
+
+namespace {
+    struct Options {
+        std::vector<std::string> suites;
+        std::vector<std::string> engines;
+        std::string instances;
+        std::string baseline;
+        double tolerance = 0.10;
+        std::uint32_t seed = 1;
+        unsigned threads = 2;
+        bool csv = false;
+    };
+
+    template<std::uint8_t N>
+    struct Instance {
+        Board<N> start;
+        Board<N> target;
+    };
+
+    template<std::uint8_t N>
+    struct Suite {
+        std::string name;
+        std::vector<Instance<N>> instances;
+        // Engines too slow or too hungry for the suite are left out
+        std::vector<std::string> engines;
+        // Depth limit given to dfs
+        std::size_t max_depth;
+    };
+
+    // Nodes smastar may hold, small enough that the harder instances evict and expand again
+    constexpr std::size_t SMA_NODES = 10000;
+
+    template<std::uint8_t N>
+    using Solver = std::function<Result(const Board<N> &, const Board<N> &, std::size_t)>;
+
+    // Heuristic tables of every target met so far, built on first use
+    template<typename H, std::uint8_t N>
+    const H &heuristic(const Board<N> &target) {
+        static std::map<typename Board<N>::Packed, std::unique_ptr<H>> built;
+        auto &table = built[target.pack()];
+        if (!table)
+            table.reset(new H(target));
+        return *table;
+    }
+
+    template<std::uint8_t N>
+    std::map<std::string, Solver<N>> solvers(unsigned threads) {
+        auto depth = [](const Node<Board<N>> &node) {
+            return node.getDepth();
+        };
+        auto manhattan = [](const Node<Board<N>> &node) {
+            return node.get().manhattan();
+        };
+        return {
+                {"bfs",               [](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::bfs(start, target);
+                }},
+                {"bidirectional-bfs", [](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::bidirectionalBfs(start, target);
+                }},
+                {"dfs",               [](const Board<N> &start, const Board<N> &target, std::size_t max_depth) {
+                    return search::dfs(start, target, max_depth);
+                }},
+                {"best-first",        [](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::bestFS<Board<N>>(start, target, [](const Node<Board<N>> &node) {
+                        return node.getDepth() + node.get().misplaced();
+                    });
+                }},
+                {"astar",             [=](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::aStar<Board<N>>(start, target, depth, manhattan);
+                }},
+                {"idastar",           [](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::idaStar<Board<N>>(start, target, [](const Board<N> &board) {
+                        return board.manhattan();
+                    });
+                }},
+                {"astar-lc",          [=](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    const auto &h = heuristic<board::LinearConflict<N>>(target);
+                    return search::aStar<Board<N>>(start, target, depth, [&h](const Node<Board<N>> &node) {
+                        return h(node.get());
+                    });
+                }},
+                {"idastar-lc",        [](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::idaStar<Board<N>>(start, target, heuristic<board::LinearConflict<N>>(target));
+                }},
+                // The larger of the two, both being admissible
+                {"idastar-wd",        [](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    const auto &wd = heuristic<board::WalkingDistance<N>>(target);
+                    const auto &lc = heuristic<board::LinearConflict<N>>(target);
+                    return search::idaStar<Board<N>>(start, target, [&wd, &lc](const Board<N> &board) {
+                        return std::max(wd(board), lc(board));
+                    });
+                }},
+                {"smastar",           [](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::smaStar<Board<N>>(start, target, [](const Board<N> &board) {
+                        return board.manhattan();
+                    }, SMA_NODES);
+                }},
+                {"parallel-astar",    [=](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::parallelAStar<Board<N>>(start, target, depth, manhattan, threads);
+                }},
+                {"parallel-idastar",  [=](const Board<N> &start, const Board<N> &target, std::size_t) {
+                    return search::parallelIdaStar<Board<N>>(start, target, [](const Board<N> &board) {
+                        return board.manhattan();
+                    }, threads);
+                }},
+        };
+    }
+
+    template<std::uint8_t N>
+    std::vector<Instance<N>> walks(const Board<N> &goal, std::size_t count, int moves, std::uint32_t seed) {
+        std::vector<Instance<N>> instances;
+        for (const auto &start : instances::randomWalks(goal, count, moves, seed))
+            instances.push_back({start, goal});
+        return instances;
+    }
+
+    // One instance per line in the batch format, the ordered board unless '/' names a target
+    template<std::uint8_t N>
+    bool load(const std::string &path, std::vector<Instance<N>> &instances) {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        std::string line;
+        while (std::getline(in, line)) {
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+                continue;
+            batch::Instance parsed;
+            auto start = batch::impl::orderedBoard<N>();
+            auto target = batch::impl::orderedBoard<N>();
+            if (!batch::impl::parse(line, parsed) || parsed.start.size() != Board<N>::SIZE ||
+                !batch::impl::makeBoard(parsed.start, start) ||
+                (!parsed.target.empty() && (parsed.target.size() != Board<N>::SIZE ||
+                                            !batch::impl::makeBoard(parsed.target, target)))) {
+                std::cerr << "Error: " << path << ": not a " << int(N) << "x" << int(N) << " instance: " << line
+                          << std::endl;
+                return false;
+            }
+            instances.push_back({start, target});
+        }
+        return true;
+    }
+
+    // High-water mark of the resident set of the whole process so far, in KiB
+    long peakRss() {
+#if defined(_WIN32)
+        return 0;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+#endif
+    }
+
+    struct Record {
+        std::string suite;
+        std::string engine;
+        std::size_t instances = 0;
+        std::size_t solved = 0;
+        double median_ms = 0;
+        double p99_ms = 0;
+        double mean_ms = 0;
+        std::int64_t expanded = 0;
+        double nodes_per_s = 0;
+        std::size_t peak_memory_kib = 0;
+        long peak_rss_kib = 0;
+    };
+
+    // Nearest-rank percentile of sorted values
+    double percentile(const std::vector<double> &sorted, double p) {
+        auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    }
+
+    template<std::uint8_t N>
+    Record measure(const Suite<N> &suite, const std::string &engine, const Solver<N> &solve) {
+        Record record;
+        record.suite = suite.name;
+        record.engine = engine;
+        std::vector<double> times;
+        double seconds = 0;
+        for (const auto &instance : suite.instances) {
+            Goal<N> goal(instance.target);
+            auto start = instance.start;
+            start.setGoal(goal);
+            auto begin = std::chrono::steady_clock::now();
+            auto result = solve(start, instance.target, suite.max_depth);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            seconds += elapsed.count();
+            times.push_back(elapsed.count() * 1e3);
+            record.solved += result.success();
+            record.expanded += result.stats().expanded;
+            record.peak_memory_kib = std::max(record.peak_memory_kib, result.stats().peak_memory / 1024);
+        }
+        std::sort(times.begin(), times.end());
+        record.instances = times.size();
+        if (!times.empty()) {
+            record.median_ms = percentile(times, 0.5);
+            record.p99_ms = percentile(times, 0.99);
+            record.mean_ms = seconds * 1e3 / static_cast<double>(times.size());
+        }
+        record.nodes_per_s = seconds > 0 ? static_cast<double>(record.expanded) / seconds : 0;
+        record.peak_rss_kib = peakRss();
+        return record;
+    }
+
+    std::string format(const Record &record, bool csv) {
+        char line[512];
+        if (csv) {
+            std::snprintf(line, sizeof(line), "%s,%s,%zu,%zu,%.4f,%.4f,%.4f,%lld,%.0f,%zu,%ld",
+                          record.suite.c_str(), record.engine.c_str(), record.instances, record.solved,
+                          record.median_ms, record.p99_ms, record.mean_ms, static_cast<long long>(record.expanded),
+                          record.nodes_per_s, record.peak_memory_kib, record.peak_rss_kib);
+        } else {
+            std::snprintf(line, sizeof(line),
+                          "{\"suite\":\"%s\",\"engine\":\"%s\",\"instances\":%zu,\"solved\":%zu,"
+                          "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"mean_ms\":%.4f,\"expanded\":%lld,"
+                          "\"nodes_per_s\":%.0f,\"peak_memory_kib\":%zu,\"peak_rss_kib\":%ld}",
+                          record.suite.c_str(), record.engine.c_str(), record.instances, record.solved,
+                          record.median_ms, record.p99_ms, record.mean_ms, static_cast<long long>(record.expanded),
+                          record.nodes_per_s, record.peak_memory_kib, record.peak_rss_kib);
+        }
+        return line;
+    }
+
+    // Value of key in one of our own JSON records, or in a CSV line by its column
+    std::string field(const std::string &line, const char *key, int column) {
+        if (!line.empty() && line[0] == '{') {
+            auto name = std::string("\"") + key + "\":";
+            auto at = line.find(name);
+            if (at == std::string::npos)
+                return {};
+            at += name.size();
+            if (line[at] == '"')
+                return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+            return line.substr(at, line.find_first_of(",}", at) - at);
+        }
+        std::istringstream is(line);
+        std::string value;
+        for (int i = 0; i <= column && std::getline(is, value, ','); ++i)
+            continue;
+        return value;
+    }
+
+    std::map<std::string, Record> readBaseline(const std::string &path) {
+        std::map<std::string, Record> baseline;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line.compare(0, 6, "suite,") == 0)
+                continue;
+            Record record;
+            record.suite = field(line, "suite", 0);
+            record.engine = field(line, "engine", 1);
+            record.median_ms = std::atof(field(line, "median_ms", 4).c_str());
+            record.expanded = std::atoll(field(line, "expanded", 7).c_str());
+            baseline[record.suite + '/' + record.engine] = record;
+        }
+        return baseline;
+    }
+
+    // Medians below this many milliseconds are left alone, they are mostly timer noise
+    constexpr double NOISE_MS = 0.05;
+
+    bool compare(const Record &record, const std::map<std::string, Record> &baseline, double tolerance) {
+        auto iter = baseline.find(record.suite + '/' + record.engine);
+        if (iter == baseline.end())
+            return true;
+        const auto &before = iter->second;
+        bool ok = true;
+        if (record.median_ms > before.median_ms * (1 + tolerance) && record.median_ms - before.median_ms > NOISE_MS) {
+            std::fprintf(stderr, "regression: %s/%s median %.4f ms, baseline %.4f ms (+%.1f%%)\n",
+                         record.suite.c_str(), record.engine.c_str(), record.median_ms, before.median_ms,
+                         (record.median_ms / before.median_ms - 1) * 100);
+            ok = false;
+        }
+        // The node counts of the parallel engines depend on how their threads interleave
+        if (record.expanded != before.expanded && record.engine.compare(0, 9, "parallel-") != 0) {
+            std::fprintf(stderr, "changed: %s/%s expanded %lld nodes, baseline %lld\n",
+                         record.suite.c_str(), record.engine.c_str(), static_cast<long long>(record.expanded),
+                         static_cast<long long>(before.expanded));
+            ok = false;
+        }
+        return ok;
+    }
+
+    bool selected(const std::vector<std::string> &names, const std::string &name) {
+        return names.empty() || std::find(names.begin(), names.end(), name) != names.end();
+    }
+
+    template<std::uint8_t N>
+    bool runSuite(const Suite<N> &suite, const Options &options, const std::map<std::string, Record> &baseline) {
+        if (!selected(options.suites, suite.name))
+            return true;
+        auto all = solvers<N>(options.threads);
+        bool ok = true;
+        for (const auto &engine : suite.engines) {
+            if (!selected(options.engines, engine))
+                continue;
+            auto record = measure(suite, engine, all.at(engine));
+            std::cout << format(record, options.csv) << std::endl;
+            ok = compare(record, baseline, options.tolerance) && ok;
+        }
+        return ok;
+    }
+
+    int usage(const char *program) {
+        std::cerr << "Usage: " << program << " [--suite NAME]... [--engine NAME]... [--instances FILE]"
+                  << " [--seed N] [--threads N] [--format json|csv] [--baseline FILE] [--tolerance FRACTION]"
+                  << std::endl
+                  << "Suites: 8-puzzle-shallow, 8-puzzle, 15-puzzle" << std::endl
+                  << "Engines: bfs, bidirectional-bfs, dfs, best-first, astar, idastar, smastar, parallel-astar,"
+                  << " parallel-idastar, astar-lc, idastar-lc, idastar-wd" << std::endl;
+        return 2;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc)
+            return usage(argv[0]);
+        if (std::strcmp(argv[i], "--suite") == 0) {
+            options.suites.emplace_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--engine") == 0) {
+            options.engines.emplace_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--instances") == 0) {
+            options.instances = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--format") == 0) {
+            options.csv = std::strcmp(argv[++i], "csv") == 0;
+        } else if (std::strcmp(argv[i], "--baseline") == 0) {
+            options.baseline = argv[++i];
+        } else if (std::strcmp(argv[i], "--tolerance") == 0) {
+            options.tolerance = std::atof(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    const Board<3> goal3 = {1, 2, 3, 4, 5, 6, 7, 8, 0};
+
+    // Shallow enough for the depth limited dfs to finish
+    Suite<3> shallow{"8-puzzle-shallow", walks(goal3, 100, 12, options.seed),
+                     {"bfs", "bidirectional-bfs", "dfs", "best-first", "astar", "idastar", "smastar",
+                      "parallel-astar", "parallel-idastar", "astar-lc", "idastar-lc", "idastar-wd"}, 12};
+    Suite<3> eight{"8-puzzle", walks(goal3, 100, 40, options.seed),
+                   {"bfs", "bidirectional-bfs", "best-first", "astar", "idastar", "smastar",
+                    "parallel-astar", "parallel-idastar", "astar-lc", "idastar-lc", "idastar-wd"}, 0};
+    // Random walks stand in for a published set; --instances swaps in any other, e.g. Korf's 100
+    Suite<4> fifteen{"15-puzzle", walks(instances::GOAL_4X4, 100, 40, options.seed),
+                     {"astar", "idastar", "smastar", "parallel-astar", "parallel-idastar", "astar-lc", "idastar-lc",
+                      "idastar-wd"}, 0};
+    if (!options.instances.empty()) {
+        fifteen.instances.clear();
+        if (!load(options.instances, fifteen.instances)) {
+            std::cerr << "Error: cannot load " << options.instances << std::endl;
+            return 1;
+        }
+    }
+
+    std::map<std::string, Record> baseline;
+    if (!options.baseline.empty())
+        baseline = readBaseline(options.baseline);
+
+    if (options.csv)
+        std::cout << "suite,engine,instances,solved,median_ms,p99_ms,mean_ms,expanded,nodes_per_s,"
+                     "peak_memory_kib,peak_rss_kib" << std::endl;
+    bool ok = runSuite(shallow, options, baseline);
+    ok = runSuite(eight, options, baseline) && ok;
+    ok = runSuite(fifteen, options, baseline) && ok;
+    return ok ? 0 : 1;
+}
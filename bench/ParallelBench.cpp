@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../Board.h"
+#include "../ParallelSearch.h"
+#include "Instances.h"
+
+using board::Board;
+using board::Goal;
+using search::Node;
+using search::Result;
+
+namespace {
+    // Runs solve(start, threads) over the medium instances for every thread count and prints the
+    // speedup over one thread
+    template<typename Solver>
+    void scale(const char *engine, const std::vector<unsigned> &counts, Solver solve) {
+        Goal<4> goal(instances::GOAL_4X4);
+        double baseline = 0;
+        for (auto threads : counts) {
+            std::int64_t nodes = 0;
+            int solved = 0;
+            auto begin = std::chrono::steady_clock::now();
+            for (auto start : instances::MEDIUM_4X4) {
+                start.setGoal(goal);
+                Result result = solve(start, threads);
+                nodes += result.steps();
+                solved += result.success();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            if (threads == counts.front())
+                baseline = elapsed.count();
+            std::printf("%-10s %8u %12lld %10.3f %12.0f %8.2f%s\n", engine, threads, static_cast<long long>(nodes),
+                        elapsed.count(), nodes / elapsed.count(), baseline / elapsed.count(),
+                        solved == static_cast<int>(instances::MEDIUM_4X4.size()) ? "" : " (unsolved instances)");
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+    if (max_threads == 0)
+        max_threads = 1;
+
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(max_threads);
+
+    std::printf("%-10s %8s %12s %10s %12s %8s\n", "engine", "threads", "nodes", "seconds", "nodes/s", "speedup");
+    scale("astar", counts, [](const Board<4> &start, unsigned threads) {
+        return search::parallelAStar<Board<4>>(
+                start, instances::GOAL_4X4,
+                [](const Node<Board<4>> &node) {
+                    return node.getDepth();
+                },
+                [](const Node<Board<4>> &node) {
+                    return node.get().manhattan();
+                },
+                threads);
+    });
+    scale("idastar", counts, [](const Board<4> &start, unsigned threads) {
+        return search::parallelIdaStar<Board<4>>(start, instances::GOAL_4X4, [](const Board<4> &board) {
+            return board.manhattan();
+        }, threads);
+    });
+    return 0;
+}
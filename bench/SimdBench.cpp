@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../Simd.h"
+
+// Times every variant of the byte kernels on random boards of 16 and 32 bytes (4x4 and 5x5)
+namespace {
+    constexpr std::size_t BOARDS = 1024;
+    constexpr int ROUNDS = 20000;
+
+    // Random permutations of 0..cells-1, zero padded to bytes, one after the other
+    std::vector<std::uint8_t> makeBoards(int cells, std::size_t bytes) {
+        std::mt19937 random(cells);
+        std::vector<std::uint8_t> boards(BOARDS * bytes, 0);
+        std::vector<std::uint8_t> pieces(static_cast<std::size_t>(cells));
+        std::iota(pieces.begin(), pieces.end(), 0);
+        for (std::size_t i = 0; i < BOARDS; ++i) {
+            std::shuffle(pieces.begin(), pieces.end(), random);
+            std::copy(pieces.begin(), pieces.end(), boards.begin() + static_cast<std::ptrdiff_t>(i * bytes));
+        }
+        // Every other board is a copy of the next so equal() sees both outcomes
+        for (std::size_t i = 0; i + 1 < BOARDS; i += 2)
+            std::memcpy(&boards[i * bytes], &boards[(i + 1) * bytes], bytes);
+        return boards;
+    }
+
+    template<typename Kernel>
+    void run(const char *kernel, const char *variant, std::size_t bytes, const std::vector<std::uint8_t> &boards,
+             Kernel call) {
+        std::int64_t checksum = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (int round = 0; round < ROUNDS; ++round)
+            for (std::size_t i = 0; i + 1 < BOARDS; ++i)
+                checksum += call(&boards[i * bytes], &boards[(i + 1) * bytes], bytes);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        auto calls = static_cast<double>(ROUNDS) * (BOARDS - 1);
+        std::printf("%-10s %-7s %5zu %10.2f ns/call %14lld\n", kernel, variant, bytes,
+                    elapsed.count() * 1e9 / calls, static_cast<long long>(checksum));
+    }
+
+    void runAll(int cells) {
+        auto bytes = static_cast<std::size_t>((cells + 15) / 16 * 16);
+        auto boards = makeBoards(cells, bytes);
+
+        run("mismatches", "scalar", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+            return simd::scalar::mismatches(a, b, n);
+        });
+        run("equal", "scalar", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+            return simd::scalar::equal(a, b, n);
+        });
+        run("find", "scalar", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *, std::size_t n) {
+            return simd::scalar::find(a, n, 0);
+        });
+#if NPUZZLE_SSE2
+        run("mismatches", "sse2", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+            return simd::sse2::mismatches(a, b, n);
+        });
+        run("equal", "sse2", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+            return simd::sse2::equal(a, b, n);
+        });
+        run("find", "sse2", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *, std::size_t n) {
+            return simd::sse2::find(a, n, 0);
+        });
+#endif
+#if NPUZZLE_HAS_AVX2_KERNELS
+        if (bytes % 32 == 0 && __builtin_cpu_supports("avx2")) {
+            run("mismatches", "avx2", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+                return simd::avx2::mismatches(a, b, n);
+            });
+            run("equal", "avx2", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+                return simd::avx2::equal(a, b, n);
+            });
+            run("find", "avx2", bytes, boards, [](const std::uint8_t *a, const std::uint8_t *, std::size_t n) {
+                return simd::avx2::find(a, n, 0);
+            });
+        }
+#endif
+        std::printf("\n");
+    }
+}
+
+int main() {
+    std::printf("%-10s %-7s %5s %18s %14s\n", "kernel", "variant", "bytes", "time", "checksum");
+    runAll(16);
+    runAll(25);
+    return 0;
+}
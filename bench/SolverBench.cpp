@@ -0,0 +1,100 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Board.h"
+#include "../Solver.h"
+#include "Instances.h"
+
+using board::Board;
+using batch::Algorithm;
+using Clock = std::chrono::steady_clock;
+
+// How promptly batch::Solver gives jobs back: the medium instances solved side by side, then a
+// hard instance with each search stopped by a time budget and by cancel(), timed from the end of
+// the budget or the call until the outcome is there, freeing the search's memory included, and
+// last a queued job cancelled before it starts.
+namespace {
+    // Far too many expansions with the Manhattan distance for any of these to finish it
+    const std::string HARD_4X4 = "15 14 13 12 11 10 9 8 7 6 5 4 3 1 2 0";
+
+    const std::vector<std::pair<const char *, Algorithm>> ALGORITHMS = {
+            {"astar",   Algorithm::A_STAR},
+            {"idastar", Algorithm::IDA_STAR},
+            {"smastar", Algorithm::SMA_STAR},
+            {"anytime", Algorithm::ANYTIME},
+    };
+
+    std::string line(const Board<4> &board) {
+        std::string pieces;
+        for (int i = 0; i < Board<4>::SIZE; ++i)
+            pieces += std::to_string(board[i]) + ' ';
+        return pieces;
+    }
+
+    double millisecondsSince(Clock::time_point begin) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    {
+        batch::Solver solver(threads);
+        batch::Options options;
+        auto begin = Clock::now();
+        std::vector<batch::Job> jobs;
+        for (const auto &board : instances::MEDIUM_4X4)
+            jobs.push_back(solver.submit(line(board), options));
+        int solved = 0;
+        for (auto &job : jobs)
+            solved += job.outcome().get().status == "solved";
+        std::printf("%d/%zu medium instances on %u threads in %.1f ms\n\n", solved, jobs.size(), threads,
+                    millisecondsSince(begin));
+    }
+
+    const int budget = 100;
+    std::printf("%-10s %-10s %10s %10s %10s\n", "engine", "stop", "status", "late ms", "progress");
+    batch::Solver solver(threads);
+    for (const auto &algorithm : ALGORITHMS) {
+        batch::Options options;
+        options.algorithm = algorithm.second;
+
+        // The budget runs from when the job starts, which with a free thread is at once
+        options.milliseconds = budget;
+        auto begin = Clock::now();
+        auto timed = solver.submit(HARD_4X4, options).outcome().get();
+        std::printf("%-10s %-10s %10s %10.1f %10s\n", algorithm.first, "deadline", timed.status.c_str(),
+                    millisecondsSince(begin) - budget, "");
+
+        options.milliseconds = 0;
+        std::atomic<int> reports{0};
+        auto job = solver.submit(HARD_4X4, options, [&reports](const search::Progress &) {
+            ++reports;
+        }, 1 << 12);
+        std::this_thread::sleep_for(std::chrono::milliseconds(budget));
+        begin = Clock::now();
+        job.cancel();
+        auto cancelled = job.outcome().get();
+        std::printf("%-10s %-10s %10s %10.1f %10d\n", algorithm.first, "cancel", cancelled.status.c_str(),
+                    millisecondsSince(begin), reports.load());
+    }
+
+    // One thread, so the second job waits behind the first and is cancelled before it starts
+    batch::Solver single(1);
+    batch::Options options;
+    options.milliseconds = budget;
+    auto running = single.submit(HARD_4X4, options);
+    auto queued = single.submit(HARD_4X4, options);
+    queued.cancel();
+    std::printf("\nqueued job %s, the one before it %s\n", queued.outcome().get().status.c_str(),
+                running.outcome().get().status.c_str());
+    return 0;
+}
@@ -1,9 +1,29 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
+#include "AnytimeSearch.h"
+#include "Batch.h"
+#include "BeamSearch.h"
 #include "Board.h"
+#include "BoundedSearch.h"
+#include "DynamicBoard.h"
+#include "ExternalSearch.h"
 #include "GraphSearch.h"
+#include "Heuristics.h"
+#include "ParallelSearch.h"
+#include "PatternDatabase.h"
+#include "Reduction.h"
 
 using board::Board;
+using board::Goal;
+using board::PatternDatabase;
 using search::Node;
 using search::Result;
 
@@ -13,6 +33,12 @@ inline Result boardBFS(const Board<N> &start, const Board<N> &target)
     return search::bfs<Board<N>>(start, target);
 }
 
+template<std::uint8_t N>
+inline Result boardBidirectionalBFS(const Board<N> &start, const Board<N> &target)
+{
+    return search::bidirectionalBfs<Board<N>>(start, target);
+}
+
 template<std::uint8_t N>
 inline Result boardDFS(const Board<N> &start, const Board<N> &target, std::size_t max_depth)
 {
@@ -22,42 +48,331 @@ inline Result boardDFS(const Board<N> &start, const Board<N> &target, std::size_
 template<std::uint8_t N>
 inline Result boardBestFS(const Board<N> &start, const Board<N> &target)
 {
-    return search::bestFS<Board<N>>(start, target, [target](const Node<Board<N>> &node) {
-        return node.getDepth() + target.compatibilityCalculate(node.get());
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    return search::bestFS<Board<N>>(source, target, [](const Node<Board<N>> &node) {
+        return node.getDepth() + node.get().misplaced();
     });
 }
 
 template<std::uint8_t N>
 inline Result boardAStar(const Board<N> &start, const Board<N> &target)
 {
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    return search::aStar<Board<N>>(source, target,
+                                   [](const Node<Board<N>> &node) {
+                                       return node.getDepth();
+                                   },
+                                   [](const Node<Board<N>> &node) {
+                                       return node.get().manhattan();
+                                   });
+}
+
+template<std::uint8_t N>
+inline Result boardLinearConflictAStar(const Board<N> &start, const Board<N> &target)
+{
+    board::LinearConflict<N> heuristic(target);
     return search::aStar<Board<N>>(start, target,
                                    [](const Node<Board<N>> &node) {
                                        return node.getDepth();
                                    },
-                                   [target](const Node<Board<N>> &node) {
-                                       return target.similarityCalculate(node.get());
+                                   [&heuristic](const Node<Board<N>> &node) {
+                                       return heuristic(node.get());
                                    });
 }
 
-int main() {
-    //    Board<3> dfs_sample = {2, 8, 3, 1, 6, 4, 7, 0, 5};
-    //    Board<3> bfs_sample = {2, 8, 3, 1, 0, 4, 7, 6, 5};
-    //    Board<3> target = {1, 2, 3, 0, 8, 4, 7, 6, 5};
+template<std::uint8_t N>
+inline Result boardParallelAStar(const Board<N> &start, const Board<N> &target, unsigned threads)
+{
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    return search::parallelAStar<Board<N>>(source, target,
+                                           [](const Node<Board<N>> &node) {
+                                               return node.getDepth();
+                                           },
+                                           [](const Node<Board<N>> &node) {
+                                               return node.get().manhattan();
+                                           },
+                                           threads);
+}
 
-    Board<4> start = {1, 2, 3, 4, 5, 10, 6, 8, 0, 9, 7, 12, 13, 14, 11, 15};
-    Board<4> target = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0};
+template<std::uint8_t N>
+inline Result boardParallelIDAStar(const Board<N> &start, const Board<N> &target, unsigned threads)
+{
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    return search::parallelIdaStar<Board<N>>(source, target, [](const Board<N> &board) {
+        return board.manhattan();
+    }, threads);
+}
 
-    std::cout << "Please input the start board:" << std::endl;
-    std::cin >> start;
-    std::cout << "Please input the target board:" << std::endl;
-    std::cin >> target;
+template<std::uint8_t N>
+inline Result boardIDAStar(const Board<N> &start, const Board<N> &target)
+{
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    return search::idaStar<Board<N>>(source, target, [](const Board<N> &board) {
+        return board.manhattan();
+    });
+}
+
+// Walking distance or linear conflict, whichever is larger, both are admissible
+template<std::uint8_t N>
+inline Result boardWalkingDistanceIDAStar(const Board<N> &start, const Board<N> &target)
+{
+    board::WalkingDistance<N> walking(target);
+    board::LinearConflict<N> conflict(target);
+    return search::idaStar<Board<N>>(start, target, [&walking, &conflict](const Board<N> &board) {
+        return std::max(walking(board), conflict(board));
+    });
+}
+
+// There are no walking distance tables for 5x5 boards, linear conflict alone
+inline Result boardWalkingDistanceIDAStar(const Board<5> &start, const Board<5> &target)
+{
+    board::LinearConflict<5> conflict(target);
+    return search::idaStar<Board<5>>(start, target, [&conflict](const Board<5> &board) {
+        return conflict(board);
+    });
+}
+
+// Prints every shorter solution found before the deadline
+template<std::uint8_t N>
+inline Result boardAnytimeAStar(const Board<N> &start, const Board<N> &target, double seconds)
+{
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    auto limits = search::Limits::within(std::chrono::duration_cast<search::Limits::Clock::duration>(
+            std::chrono::duration<double>(seconds)));
+    return search::anytimeAStar<Board<N>>(source, target,
+                                          [](const Node<Board<N>> &node) {
+                                              return node.getDepth();
+                                          },
+                                          [](const Node<Board<N>> &node) {
+                                              return node.get().manhattan();
+                                          },
+                                          [](const Result &result, double weight) {
+                                              if (std::isinf(weight))
+                                                  std::cout << "Unbounded";
+                                              else
+                                                  std::cout << "Weight " << weight;
+                                              std::cout << ": length " << result.length() << " after "
+                                                        << result.stats().expanded << " expansions" << std::endl;
+                                              return true;
+                                          },
+                                          search::AnytimeOptions(), limits);
+}
+
+template<std::uint8_t N>
+inline Result boardBeamSearch(const Board<N> &start, const Board<N> &target, std::size_t width)
+{
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    search::BeamOptions options;
+    options.width = width;
+    return search::beamSearch<Board<N>>(source, target, [](const Board<N> &board) {
+        return board.manhattan();
+    }, options);
+}
+
+template<std::uint8_t N>
+inline Result boardSMAStar(const Board<N> &start, const Board<N> &target, std::size_t bytes)
+{
+    Goal<N> goal(target);
+    auto source = start;
+    source.setGoal(goal);
+    return search::smaStar<Board<N>>(source, target, [](const Board<N> &board) {
+        return board.manhattan();
+    }, search::smaStarCapacity<Board<N>>(bytes));
+}
+
+template<std::uint8_t N>
+inline Result boardPatternIDAStar(const Board<N> &start, const Board<N> &target, const std::string &path)
+{
+    auto pdb = PatternDatabase<N>::load(target, path);
+    if (!pdb) {
+        std::cout << "Building the pattern database..." << std::endl;
+        pdb.reset(new PatternDatabase<N>(target, PatternDatabase<N>::defaultPatterns()));
+        if (!pdb->save(path))
+            std::cout << "Warning: failed to write " << path << std::endl;
+    }
+    const auto &heuristic = *pdb;
+    return search::idaStar<Board<N>>(start, target, [&heuristic](const Board<N> &board) {
+        return heuristic(board);
+    });
+}
+
+int batchMain(int argc, char *argv[])
+{
+    batch::Options options;
+    const char *path = nullptr;
+    bool valid = true;
+    for (int i = 2; i < argc && valid; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            auto format = argv[++i];
+            options.format = std::strcmp(format, "csv") == 0 ? batch::Format::CSV : batch::Format::JSON;
+            valid = std::strcmp(format, "csv") == 0 || std::strcmp(format, "json") == 0;
+        } else if (std::strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc) {
+            auto algorithm = argv[++i];
+            if (std::strcmp(algorithm, "astar") == 0)
+                options.algorithm = batch::Algorithm::A_STAR;
+            else if (std::strcmp(algorithm, "idastar") == 0)
+                options.algorithm = batch::Algorithm::IDA_STAR;
+            else if (std::strcmp(algorithm, "smastar") == 0)
+                options.algorithm = batch::Algorithm::SMA_STAR;
+            else if (std::strcmp(algorithm, "table") == 0)
+                options.algorithm = batch::Algorithm::TABLE;
+            else if (std::strcmp(algorithm, "wastar") == 0)
+                options.algorithm = batch::Algorithm::WEIGHTED_A_STAR;
+            else if (std::strcmp(algorithm, "anytime") == 0)
+                options.algorithm = batch::Algorithm::ANYTIME;
+            else if (std::strcmp(algorithm, "beam") == 0)
+                options.algorithm = batch::Algorithm::BEAM;
+            else
+                valid = false;
+        } else if (std::strcmp(argv[i], "--memory") == 0 && i + 1 < argc) {
+            options.memory = static_cast<std::size_t>(std::atoll(argv[++i])) << 20;
+        } else if (std::strcmp(argv[i], "--table") == 0 && i + 1 < argc) {
+            options.table = argv[++i];
+        } else if (std::strcmp(argv[i], "--weight") == 0 && i + 1 < argc) {
+            options.weight = std::atof(argv[++i]);
+            valid = options.weight >= 1;
+        } else if (std::strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            options.milliseconds = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-expanded") == 0 && i + 1 < argc) {
+            options.max_expanded = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--beam-width") == 0 && i + 1 < argc) {
+            options.beam_width = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid) {
+        std::cerr << "Usage: " << argv[0] << " --batch [FILE|-] [--threads N] [--format json|csv]"
+                  << " [--algorithm astar|idastar|smastar|table|wastar|anytime|beam]"
+                  << " [--memory MIB] [--table FILE] [--weight W] [--time-limit MS]"
+                  << " [--max-expanded N] [--beam-width N]" << std::endl;
+        return 2;
+    }
+
+    batch::Summary summary;
+    if (!path || std::strcmp(path, "-") == 0) {
+        summary = batch::run(std::cin, std::cout, options);
+    } else {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Error: cannot open " << path << std::endl;
+            return 1;
+        }
+        summary = batch::run(in, std::cout, options);
+    }
+
+    std::cerr << "Solved " << summary.solved << " of " << summary.puzzles << " puzzles in " << summary.seconds
+              << " s, " << summary.puzzles / summary.seconds << " puzzles/s" << std::endl;
+    return 0;
+}
+
+// Counts the states at each distance from the ordered board, with their mean Manhattan distance
+template<std::uint8_t N>
+int enumerate(const search::ExternalOptions &options)
+{
+    auto start = batch::impl::orderedBoard<N>();
+    Goal<N> goal(start);
+    std::vector<std::uint64_t> manhattan;
+    auto enumeration = search::externalBfs(start, options, [&](const Board<N> &board, int depth) {
+        Board<N> state = board;
+        state.setGoal(goal);
+        if (manhattan.size() <= static_cast<std::size_t>(depth))
+            manhattan.resize(depth + 1);
+        manhattan[depth] += state.manhattan();
+    });
+
+    std::cout << "depth,states,mean_manhattan" << std::endl;
+    for (std::size_t depth = 0; depth < enumeration.layers.size(); ++depth)
+        std::cout << depth << ',' << enumeration.layers[depth] << ','
+                  << static_cast<double>(manhattan[depth]) / enumeration.layers[depth] << std::endl;
+    std::cerr << enumeration.states() << " states in " << enumeration.stats.seconds() << " s, "
+              << enumeration.written / (1 << 20) << " MiB written" << std::endl;
+    if (!enumeration.complete) {
+        std::cerr << "Error: cannot write or read the layers in " << options.directory << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int enumerateMain(int argc, char *argv[])
+{
+    search::ExternalOptions options;
+    int size = 3;
+    bool valid = true;
+    for (int i = 2; i < argc && valid; ++i) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            size = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--directory") == 0 && i + 1 < argc) {
+            options.directory = argv[++i];
+        } else if (std::strcmp(argv[i], "--memory") == 0 && i + 1 < argc) {
+            options.memory = static_cast<std::size_t>(std::atoll(argv[++i])) << 20;
+        } else if (std::strcmp(argv[i], "--max-depth") == 0 && i + 1 < argc) {
+            options.max_depth = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--keep") == 0) {
+            options.keep = true;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || size < 3 || size > 5) {
+        std::cerr << "Usage: " << argv[0] << " --enumerate [--size 3|4|5] [--directory DIR] [--memory MIB]"
+                  << " [--max-depth N] [--keep]" << std::endl;
+        return 2;
+    }
+
+    switch (size) {
+        case 3:
+            return enumerate<3>(options);
+        case 4:
+            return enumerate<4>(options);
+        default:
+            return enumerate<5>(options);
+    }
+}
+
+// Shows the search methods and runs the one picked
+template<std::uint8_t N>
+Result solveBoard(const std::vector<int> &start_pieces, const std::vector<int> &target_pieces)
+{
+    auto start = batch::impl::orderedBoard<N>();
+    auto target = batch::impl::orderedBoard<N>();
+    batch::impl::makeBoard(start_pieces, start);
+    batch::impl::makeBoard(target_pieces, target);
 
     std::cout << "The search method implemented: " << std::endl;
     std::cout << "1. Breadth First Search" << std::endl;
     std::cout << "2. Depth First Search" << std::endl;
     std::cout << "3. Best First Search" << std::endl;
     std::cout << "4. A* Search" << std::endl;
-    std::cout << "Please select the search method [1-4]: ";
+    std::cout << "5. IDA* Search" << std::endl;
+    std::cout << "6. IDA* Search with pattern database" << std::endl;
+    std::cout << "7. Parallel A* Search" << std::endl;
+    std::cout << "8. Bidirectional Breadth First Search" << std::endl;
+    std::cout << "9. Memory-bounded A* Search" << std::endl;
+    std::cout << "10. A* Search with linear conflict" << std::endl;
+    std::cout << "11. IDA* Search with walking distance" << std::endl;
+    std::cout << "12. Parallel IDA* Search" << std::endl;
+    std::cout << "13. Anytime A* Search" << std::endl;
+    std::cout << "14. Beam Search" << std::endl;
+    std::cout << "Please select the search method [1-14]: ";
 
     int option;
     std::cin >> option;
@@ -80,16 +395,225 @@ int main() {
         case 4:
             result = boardAStar(start, target);
             break;
+        case 5:
+            result = boardIDAStar(start, target);
+            break;
+        case 6:
+        {
+            std::string path;
+            std::cout << "Please input the pattern database file: ";
+            std::cin >> path;
+            result = boardPatternIDAStar(start, target, path);
+        }
+            break;
+        case 7:
+        {
+            unsigned threads;
+            std::cout << "Please input the number of threads: ";
+            std::cin >> threads;
+            result = boardParallelAStar(start, target, threads);
+        }
+            break;
+        case 8:
+            result = boardBidirectionalBFS(start, target);
+            break;
+        case 9:
+        {
+            std::size_t megabytes;
+            std::cout << "Please input the memory budget in MiB: ";
+            std::cin >> megabytes;
+            result = boardSMAStar(start, target, megabytes << 20);
+        }
+            break;
+        case 10:
+            result = boardLinearConflictAStar(start, target);
+            break;
+        case 11:
+            result = boardWalkingDistanceIDAStar(start, target);
+            break;
+        case 12:
+        {
+            unsigned threads;
+            std::cout << "Please input the number of threads: ";
+            std::cin >> threads;
+            result = boardParallelIDAStar(start, target, threads);
+        }
+            break;
+        case 13:
+        {
+            double seconds;
+            std::cout << "Please input the time limit in seconds: ";
+            std::cin >> seconds;
+            result = boardAnytimeAStar(start, target, seconds);
+        }
+            break;
+        case 14:
+        {
+            std::size_t width;
+            std::cout << "Please input the beam width: ";
+            std::cin >> width;
+            result = boardBeamSearch(start, target, width);
+        }
+            break;
         default:
             std::cout << "Error: Unsupported option!" << std::endl;
             break;
     }
+    return result;
+}
+
+// 2x2 and boards past 5x5 have no Board<N>; the large ones have only one method that solves them
+// in any reasonable time, and reductionSearch() hands a 2x2 board straight to A*
+Result solveDynamicBoard(int side, const std::vector<int> &start_pieces, const std::vector<int> &target_pieces)
+{
+    std::vector<board::DynamicBoard::Piece> start_grid;
+    std::vector<board::DynamicBoard::Piece> target_grid;
+    batch::impl::makeGrid(start_pieces, start_grid);
+    batch::impl::makeGrid(target_pieces, target_grid);
+
+    search::BeamOptions options;
+    if (side > 5) {
+        std::size_t width;
+        std::cout << "Boards larger than 5x5 are solved a row and a column at a time by beam search." << std::endl;
+        std::cout << "Please input the beam width: ";
+        std::cin >> width;
+        options.width = width;
+    } else {
+        std::cout << "2x2 boards are solved by A*." << std::endl;
+    }
+    return board::reductionSearch(board::DynamicBoard(side, std::move(start_grid)),
+                                  board::DynamicBoard(side, std::move(target_grid)), options);
+}
+
+// Reads the pieces of a board from the next line that has any
+bool readPieces(std::istream &is, std::vector<int> &pieces)
+{
+    std::string line;
+    while (std::getline(is, line)) {
+        std::istringstream ls(line);
+        int piece;
+        pieces.clear();
+        while (ls >> piece)
+            pieces.push_back(piece);
+        if (!pieces.empty())
+            return true;
+    }
+    return false;
+}
+
+void printStatistics(const search::Statistics &stats)
+{
+    std::cout << "Expanded: " << stats.expanded << ", generated: " << stats.generated
+              << ", duplicates: " << stats.duplicates << std::endl;
+    if (stats.evicted != 0)
+        std::cout << "Evicted: " << stats.evicted << ", re-expanded: " << stats.reexpanded << std::endl;
+    std::cout << "Peak open: " << stats.peak_open << ", peak closed: " << stats.peak_closed
+              << ", peak memory: " << stats.peak_memory / 1024 << " KiB" << std::endl;
+    for (const auto &phase : stats.phases)
+        std::cout << "  " << phase.name << ": " << phase.seconds << " s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0)
+        return batchMain(argc, argv);
+    if (argc > 1 && std::strcmp(argv[1], "--enumerate") == 0)
+        return enumerateMain(argc, argv);
+
+    // Every node is traced to the console unless asked otherwise
+    auto trace = search::Trace::FULL;
+    std::int64_t interval = 1000;
+    std::ofstream trace_file;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            auto level = argv[++i];
+            if (std::strcmp(level, "off") == 0) {
+                trace = search::Trace::OFF;
+            } else if (std::strcmp(level, "sampled") == 0) {
+                trace = search::Trace::SAMPLED;
+            } else if (std::strcmp(level, "full") != 0) {
+                std::cerr << "Error: unknown trace level " << level << std::endl;
+                return 2;
+            }
+        } else if (std::strcmp(argv[i], "--trace-interval") == 0 && i + 1 < argc) {
+            interval = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--trace-file") == 0 && i + 1 < argc) {
+            trace_file.open(argv[++i]);
+            if (!trace_file) {
+                std::cerr << "Error: cannot open " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--trace off|sampled|full] [--trace-interval N]"
+                      << " [--trace-file FILE]" << std::endl
+                      << "       " << argv[0] << " --batch [FILE|-] [--threads N] [--format json|csv]"
+                      << " [--algorithm astar|idastar|smastar|table|wastar|anytime|beam]"
+                      << " [--memory MIB] [--table FILE] [--weight W] [--time-limit MS]"
+                      << " [--max-expanded N] [--beam-width N]" << std::endl
+                      << "       " << argv[0] << " --enumerate [--size 3|4|5] [--directory DIR] [--memory MIB]"
+                      << " [--max-depth N] [--keep]" << std::endl;
+            return 2;
+        }
+    }
+    search::setTrace(trace, trace_file.is_open() ? static_cast<std::ostream &>(trace_file) : std::cout, interval);
+
+    //    Board<3> dfs_sample = {2, 8, 3, 1, 6, 4, 7, 0, 5};
+    //    Board<3> bfs_sample = {2, 8, 3, 1, 0, 4, 7, 6, 5};
+    //    Board<3> target = {1, 2, 3, 0, 8, 4, 7, 6, 5};
+
+    // The size follows from the count of pieces
+    std::vector<int> start_pieces;
+    std::vector<int> target_pieces;
+    std::cout << "Please input the start board, its pieces row by row on one line:" << std::endl;
+    readPieces(std::cin, start_pieces);
+    std::cout << "Please input the target board:" << std::endl;
+    readPieces(std::cin, target_pieces);
+
+    auto side = static_cast<int>(std::lround(std::sqrt(static_cast<double>(start_pieces.size()))));
+    std::vector<board::DynamicBoard::Piece> start_grid;
+    std::vector<board::DynamicBoard::Piece> target_grid;
+    if (side < 2 || side > board::DynamicBoard::MAX_SIDE || side * side != static_cast<int>(start_pieces.size()) ||
+        target_pieces.size() != start_pieces.size() || !batch::impl::makeGrid(start_pieces, start_grid) ||
+        !batch::impl::makeGrid(target_pieces, target_grid)) {
+        std::cout << "Error: the boards must be permutations of 0..n*n-1 for the same n from 2 to "
+                  << board::DynamicBoard::MAX_SIDE << "." << std::endl;
+        return 2;
+    }
+    if (!board::solvable(board::DynamicBoard(side, start_grid), board::DynamicBoard(side, target_grid))) {
+        std::cout << "Unsolvable: the target board cannot be reached from the start board." << std::endl;
+        return 1;
+    }
+
+    Result result;
+    switch (side) {
+        case 3:
+            result = solveBoard<3>(start_pieces, target_pieces);
+            break;
+        case 4:
+            result = solveBoard<4>(start_pieces, target_pieces);
+            break;
+        case 5:
+            result = solveBoard<5>(start_pieces, target_pieces);
+            break;
+        default:
+            result = solveDynamicBoard(side, start_pieces, target_pieces);
+            break;
+    }
 
     std::cout << "Total Steps: " << result.steps() << std::endl;
     if (result.success())
         std::cout << "Success.";
+    else if (result.unsolvable())
+        std::cout << "Unsolvable.";
     else
         std::cout << "Failed.";
+    std::cout << std::endl;
+    if (result.success()) {
+        std::cout << "Solution length: " << result.length() << std::endl << "Moves: ";
+        for (auto move : result.path().moves<board::Move>())
+            std::cout << board::symbol(move);
+        std::cout << std::endl;
+    }
+    printStatistics(result.stats());
 
     return 0;
 }